@@ -0,0 +1,48 @@
+#ifndef AVL_H
+#define AVL_H
+
+#include <stddef.h>
+#include "../concurrent/task_pool.h"
+#include "../alloc/slab.h"
+
+#define ERR_DATA_EXISTS -2
+
+#define AVL_PAR_SPAWN_DEPTH 12u /* below this depth avl_destroy_parallel stops spawning */
+
+/**
+ * every node keeps the height of its subtree, so checking the balance of a
+ * node is O(1) and insert/delete fix the tree on the way back to the root
+ * in O(log n), with at most one (single or double) rotation per level.
+ * build with -DAVL_TRACE to print which rotation case every fix takes.
+ */
+typedef struct node {
+    int val;
+    int height;            /* leaf is 1 */
+    struct node *left;
+    struct node *right;
+    struct node *parent;
+} Node;
+
+enum rot_case_type {
+    LL,
+    RR,
+    LR,
+    RL
+};
+
+typedef struct avl {
+    Node *root;
+    size_t size;
+    NodeAllocator *alloc;   /* NULL is malloc, set after avl_init to opt in */
+} AVL;
+
+int avl_init(AVL *avl);
+int avl_destroy(AVL *avl);
+int avl_destroy_parallel(AVL *avl, TaskPool *pool);   /* the two subtrees of every node are freed concurrently */
+int avl_insert(AVL *avl, int val);                    /* ERR_DATA_EXISTS if val is already there */
+Node *avl_search(AVL *avl, int val);
+int avl_delete(AVL *avl, int val);                    /* 0 even if val is not there */
+int avl_level_order_print(AVL *avl);
+int avl_in_order_print(AVL *avl);
+
+#endif
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include "avl.h"
+
+int main(){
+    AVL avl;
+    avl_init(&avl);
+
+    avl_insert(&avl, 2);
+    avl_insert(&avl, 5);
+    avl_insert(&avl, 8);
+    avl_insert(&avl, 4);
+    avl_insert(&avl, 3);
+    avl_insert(&avl, 1);
+    avl_insert(&avl, 9);
+    avl_insert(&avl, 10);
+    avl_insert(&avl, 7);
+    avl_insert(&avl, 6);
+
+    avl_delete(&avl, 5);
+    avl_delete(&avl, 4);
+    avl_delete(&avl, 3);
+    avl_delete(&avl, 8);
+    avl_delete(&avl, 7);
+    avl_delete(&avl, 6);
+    avl_delete(&avl, 2);
+    avl_delete(&avl, 9);
+    avl_delete(&avl, 1);
+    avl_delete(&avl, 10);
+    
+    avl_level_order_print(&avl);
+
+    int to_search = 6;
+    if(avl_search(&avl, to_search)){
+        printf("%d is found\n", to_search);
+    } else {
+        printf("%d is not found\n", to_search);
+    }
+
+    TaskPool pool;
+    task_pool_init(&pool, 0);
+    avl_destroy_parallel(&avl, &pool);
+    task_pool_destruct(&pool);
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef DEAP_H
+#define DEAP_H
+
+#include <stddef.h>
+
+/**
+ * deap->arr[0](root) is empty
+ * deap->arr[0 * 2 + 1](left) is min heap
+ * deap->arr[0 * 2 + 2](right) is max heap
+ * values live in arr[1 .. size], so the deap is a complete binary tree by index
+ * deap[i] <= deap[j], i is index of min heap, j is its partner in max heap
+ * how to find level of index i? Using i_level = lg2(i + 1)
+ * how to find j from i? Using this formula: j = i + 2^(i_level - 1)
+ */
+typedef struct deap {
+    int *arr;
+    size_t size;
+    size_t capacity;   /* power of 2 */
+    size_t level;
+} Deap;
+
+int deap_init(Deap *deap);
+int deap_insert(Deap *deap, int val);
+int deap_delete_min(Deap *deap);   /* return 0 if empty */
+int deap_delete_max(Deap *deap);   /* return 0 if empty */
+int deap_destroy(Deap *deap);
+int deap_print(Deap *deap);
+
+#endif
@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include "deap_fc.h"
+
+enum {
+    FC_INSERT,
+    FC_DELETE_MIN,
+    FC_DELETE_MAX
+};
+
+/* runs on the combiner only, so the deap itself stays sequential */
+static long deap_fc_apply(void *obj, int op, long arg){
+    Deap *deap = obj;
+
+    switch(op){
+        case FC_INSERT:
+            return deap_insert(deap, (int) arg);
+
+        case FC_DELETE_MIN:
+            return deap_delete_min(deap);
+
+        case FC_DELETE_MAX:
+            return deap_delete_max(deap);
+
+        default: /* should not reach here */
+            return 0;
+    }
+}
+
+int deap_fc_init(DeapFc *dfc){
+    deap_init(&dfc->deap);
+    return fc_init(&dfc->fc, &dfc->deap, deap_fc_apply);
+}
+
+int deap_fc_destroy(DeapFc *dfc){
+    fc_destruct(&dfc->fc);
+    return deap_destroy(&dfc->deap);
+}
+
+FcSlot *deap_fc_register(DeapFc *dfc){
+    return fc_register(&dfc->fc);
+}
+
+void deap_fc_unregister(FcSlot *slot){
+    fc_unregister(slot);
+}
+
+int deap_fc_insert(DeapFc *dfc, FcSlot *slot, int val){
+    return (int) fc_execute(&dfc->fc, slot, FC_INSERT, val);
+}
+
+int deap_fc_delete_min(DeapFc *dfc, FcSlot *slot){
+    return (int) fc_execute(&dfc->fc, slot, FC_DELETE_MIN, 0);
+}
+
+int deap_fc_delete_max(DeapFc *dfc, FcSlot *slot){
+    return (int) fc_execute(&dfc->fc, slot, FC_DELETE_MAX, 0);
+}
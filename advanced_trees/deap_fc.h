@@ -0,0 +1,21 @@
+#ifndef DEAP_FC_H
+#define DEAP_FC_H
+
+#include "deap.h"
+#include "../concurrent/flat_combining.h"
+
+/* deap shared by many threads through flat combining, each thread passes its own slot */
+typedef struct deap_fc {
+    Deap deap;
+    Fc fc;
+} DeapFc;
+
+int deap_fc_init(DeapFc *dfc);
+int deap_fc_destroy(DeapFc *dfc);
+FcSlot *deap_fc_register(DeapFc *dfc);
+void deap_fc_unregister(FcSlot *slot);
+int deap_fc_insert(DeapFc *dfc, FcSlot *slot, int val);
+int deap_fc_delete_min(DeapFc *dfc, FcSlot *slot);
+int deap_fc_delete_max(DeapFc *dfc, FcSlot *slot);
+
+#endif
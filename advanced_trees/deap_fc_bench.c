@@ -0,0 +1,123 @@
+/* throughput of a shared deap: flat combining vs one global mutex */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include "deap_fc.h"
+
+#define OPS_PER_THREAD 200000u
+#define MAX_THREADS 16u
+#define PREFILL 1024u
+
+typedef struct bench_arg {
+    DeapFc *dfc;
+    Deap *deap;
+    pthread_mutex_t *lock;
+    pthread_barrier_t *barrier;
+    unsigned int seed;
+} BenchArg;
+
+/* half inserts, a quarter each of delete min and delete max, so the size stays put */
+static void *fc_worker(void *arg){
+    BenchArg *a = arg;
+    FcSlot *slot = deap_fc_register(a->dfc);
+    pthread_barrier_wait(a->barrier);
+
+    for(size_t i = 0; i < OPS_PER_THREAD; ++i){
+        int r = rand_r(&a->seed);
+        switch(r & 3){
+            case 0:
+            case 1:
+                deap_fc_insert(a->dfc, slot, r >> 2);
+                break;
+            case 2:
+                deap_fc_delete_min(a->dfc, slot);
+                break;
+            default:
+                deap_fc_delete_max(a->dfc, slot);
+                break;
+        }
+    }
+    deap_fc_unregister(slot);
+    return NULL;
+}
+
+static void *mutex_worker(void *arg){
+    BenchArg *a = arg;
+    pthread_barrier_wait(a->barrier);
+
+    for(size_t i = 0; i < OPS_PER_THREAD; ++i){
+        int r = rand_r(&a->seed);
+        pthread_mutex_lock(a->lock);
+        switch(r & 3){
+            case 0:
+            case 1:
+                deap_insert(a->deap, r >> 2);
+                break;
+            case 2:
+                deap_delete_min(a->deap);
+                break;
+            default:
+                deap_delete_max(a->deap);
+                break;
+        }
+        pthread_mutex_unlock(a->lock);
+    }
+    return NULL;
+}
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double run(void *(*worker)(void *), BenchArg *tmpl, size_t nthreads){
+    pthread_t tids[MAX_THREADS];
+    BenchArg args[MAX_THREADS];
+    pthread_barrier_t barrier;
+    double start;
+
+    pthread_barrier_init(&barrier, NULL, nthreads + 1);
+    for(size_t i = 0; i < nthreads; ++i){
+        args[i] = *tmpl;
+        args[i].barrier = &barrier;
+        args[i].seed = (unsigned int) i + 1;
+        pthread_create(&tids[i], NULL, worker, &args[i]);
+    }
+
+    start = now_sec();
+    pthread_barrier_wait(&barrier);
+    for(size_t i = 0; i < nthreads; ++i)
+        pthread_join(tids[i], NULL);
+
+    pthread_barrier_destroy(&barrier);
+    return (double) OPS_PER_THREAD * nthreads / (now_sec() - start);
+}
+
+int main(){
+    printf("%8s %16s %16s\n", "threads", "fc ops/s", "mutex ops/s");
+    for(size_t n = 1; n <= MAX_THREADS; n <<= 1){
+        DeapFc dfc;
+        Deap deap;
+        pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+        BenchArg arg = { .dfc = &dfc, .deap = &deap, .lock = &lock };
+
+        deap_fc_init(&dfc);
+        deap_init(&deap);
+        for(size_t i = 0; i < PREFILL; ++i){
+            deap_insert(&dfc.deap, (int) i);
+            deap_insert(&deap, (int) i);
+        }
+
+        double f = run(fc_worker, &arg, n);
+        double m = run(mutex_worker, &arg, n);
+        printf("%8zu %16.0f %16.0f\n", n, f, m);
+
+        deap_fc_destroy(&dfc);
+        deap_destroy(&deap);
+    }
+
+    return 0;
+}
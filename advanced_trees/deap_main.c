@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "deap.h"
+
+int main(){
+    Deap deap;
+    deap_init(&deap);
+
+    deap_insert(&deap, 1);
+    deap_insert(&deap, 90);
+    deap_insert(&deap, 3);
+    deap_insert(&deap, 5);
+    deap_insert(&deap, 40);
+    deap_insert(&deap, 80);
+    deap_insert(&deap, 10);
+    deap_insert(&deap, 11);
+    deap_insert(&deap, 17);
+    deap_insert(&deap, 16);
+    deap_insert(&deap, 30);
+    deap_insert(&deap, 20);
+    deap_insert(&deap, 70);
+    deap_insert(&deap, 60);
+    deap_print(&deap);
+
+    int min = deap_delete_min(&deap);
+    printf("min: %d\n", min);
+    deap_print(&deap);
+    min = deap_delete_min(&deap);
+    printf("min: %d\n", min);
+    deap_print(&deap);
+    
+    int max = deap_delete_max(&deap);
+    printf("max: %d\n", max);
+    deap_print(&deap);
+    max = deap_delete_max(&deap);
+    printf("max: %d\n", max);
+    deap_print(&deap);
+
+    deap_destroy(&deap);
+    exit(EXIT_SUCCESS);
+}
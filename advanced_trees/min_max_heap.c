@@ -4,6 +4,7 @@
 #include <errno.h>
 #include <stdalign.h>
 #include <inttypes.h>
+#include "../alloc/slab.h"
 
 #define err_exit(msg) \
     do { \
@@ -29,6 +30,7 @@ typedef struct node {
 typedef struct min_max_heap {
     Node *root;
     Node *last_node;
+    NodeAllocator *alloc;   /* NULL is malloc, set after mmheap_init to opt in */
 } MinMaxHeap;
 
 enum {
@@ -49,7 +51,7 @@ static int mmheap_delete(MinMaxHeap *mmheap, int delete_min);
 static int mmheap_print(MinMaxHeap *mmheap);
 static Node **mmheap_find_next_pos(MinMaxHeap *mmheap, Node **next_pos_parent, int *is_left); /* return is the next_pos */
 
-static Node *node_new(int val);
+static Node *node_new(NodeAllocator *alloc, int val);
 static int node_swap_val(Node *n1, Node *n2);
 static int node_verify(Node *node_challenge, int verify_min);
 static int node_verify_min(Node *node_challenge);
@@ -114,6 +116,7 @@ int main(){
 
 static int mmheap_init(MinMaxHeap *mmheap){
     mmheap->root = NULL;
+    mmheap->alloc = NULL;
 }
 
 static int mmheap_destroy(MinMaxHeap *mmheap){
@@ -125,13 +128,13 @@ static int mmheap_destroy(MinMaxHeap *mmheap){
     mmheap_destroy(mmheap);
     mmheap->root = node->right;
     mmheap_destroy(mmheap);
-    free(node);
+    node_free(mmheap->alloc, node, sizeof(Node));
 }
 
 static int mmheap_insert(MinMaxHeap *mmheap, int val){
     Node **root = &mmheap->root;
     Node **next_pos, *next_pos_parent;
-    Node *new_node = node_new(val);
+    Node *new_node = node_new(mmheap->alloc, val);
     int is_left;
 
     if(!(*root)){
@@ -277,7 +280,7 @@ static int mmheap_delete(MinMaxHeap *mmheap, int delete_min){
         last_node->parent->left = NULL;
     else if(last_node->is_left == 1)
         last_node->parent->right = NULL;
-    free(last_node);
+    node_free(mmheap->alloc, last_node, sizeof(Node));
     mmheap->last_node = prev_last_node;
 
 again:
@@ -472,8 +475,8 @@ int rbuf_isempty(Rbuf *rbuf){
     return (rbuf->size == 0);
 }
 
-static Node *node_new(int val){
-    Node *new_node = malloc(sizeof(Node));
+static Node *node_new(NodeAllocator *alloc, int val){
+    Node *new_node = node_alloc(alloc, sizeof(Node));
     if(!new_node)
         err_exit("malloc new node");
     new_node->val = val;
@@ -0,0 +1,203 @@
+#include    <stdatomic.h>
+#include    <stdint.h>
+#include    "slab.h"
+
+static const size_t slab_class_size[SLAB_CLASSES] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+
+/* (size + 15) / 16 -> class */
+static const unsigned char slab_class_of[SLAB_MAX_SIZE / 16 + 1] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7
+};
+
+/**
+ * cache rows are handed out from a process-wide bitmap and given back by a
+ * thread-specific key destructor when the thread exits, so pools that create
+ * fresh threads keep getting rows. A thread that finds none free takes the
+ * locked path and tries again on its next call.
+ */
+static _Atomic uint64_t slab_tid_used;
+static pthread_key_t slab_tid_key;
+static pthread_once_t slab_tid_once = PTHREAD_ONCE_INIT;
+static _Thread_local unsigned int slab_tid;     /* 1-based, 0 while the thread holds no row */
+
+_Static_assert(SLAB_MAX_THREADS <= 64, "one bit per cache row");
+
+static void slab_tid_release(void *value){
+    unsigned int tid = (unsigned int) (uintptr_t) value;
+    atomic_fetch_and_explicit(&slab_tid_used, ~((uint64_t) 1 << (tid - 1)), memory_order_release);
+}
+
+static void slab_tid_key_create(void){
+    pthread_key_create(&slab_tid_key, slab_tid_release);
+}
+
+static unsigned int slab_tid_acquire(void){
+    uint64_t used = atomic_load_explicit(&slab_tid_used, memory_order_relaxed);
+    unsigned int bit;
+
+    for(;;){
+	bit = 0;
+	while(bit < SLAB_MAX_THREADS && (used >> bit & 1u))
+	    ++bit;
+	if(bit == SLAB_MAX_THREADS)
+	    return 0;
+	if(atomic_compare_exchange_weak_explicit(&slab_tid_used, &used, used | (uint64_t) 1 << bit,
+		    memory_order_acquire, memory_order_relaxed))
+	    break;
+    }
+
+    pthread_once(&slab_tid_once, slab_tid_key_create);
+    pthread_setspecific(slab_tid_key, (void *) (uintptr_t) (bit + 1));
+    return bit + 1;
+}
+
+/* the calling thread's caches, NULL while every row is taken */
+static SlabTCache *slab_tcache(SlabArena *arena){
+    if(!slab_tid)
+	slab_tid = slab_tid_acquire();
+    if(!slab_tid)
+	return NULL;
+    return arena->threads[slab_tid - 1].cache;
+}
+
+static void *slab_arena_alloc(NodeAllocator *a, size_t size){
+    return slab_alloc((SlabArena *) a, size);
+}
+
+static void slab_arena_free(NodeAllocator *a, void *ptr, size_t size){
+    slab_free((SlabArena *) a, ptr, size);
+}
+
+static void slab_arena_release(NodeAllocator *a){
+    slab_arena_reset((SlabArena *) a);
+}
+
+int slab_arena_init(SlabArena *arena){
+    arena->base.alloc = slab_arena_alloc;
+    arena->base.free = slab_arena_free;
+    arena->base.release = slab_arena_release;
+
+    for(size_t c = 0; c < SLAB_CLASSES; ++c){
+	SlabClass *cls = &arena->classes[c];
+	pthread_mutex_init(&cls->lock, NULL);
+	cls->free = NULL;
+	cls->bump = cls->end = NULL;
+	cls->slabs = NULL;
+    }
+    for(size_t t = 0; t < SLAB_MAX_THREADS; ++t)
+	for(size_t c = 0; c < SLAB_CLASSES; ++c)
+	    arena->threads[t].cache[c] = (SlabTCache){ .head = NULL, .count = 0 };
+    return 0;
+}
+
+void slab_arena_reset(SlabArena *arena){
+    for(size_t c = 0; c < SLAB_CLASSES; ++c){
+	SlabClass *cls = &arena->classes[c];
+	void *slab = cls->slabs;
+	while(slab){
+	    void *next = *(void **) slab;
+	    free(slab);
+	    slab = next;
+	}
+	cls->slabs = NULL;
+	cls->free = NULL;
+	cls->bump = cls->end = NULL;
+    }
+    for(size_t t = 0; t < SLAB_MAX_THREADS; ++t)
+	for(size_t c = 0; c < SLAB_CLASSES; ++c)
+	    arena->threads[t].cache[c] = (SlabTCache){ .head = NULL, .count = 0 };
+}
+
+void slab_arena_destroy(SlabArena *arena){
+    slab_arena_reset(arena);
+    for(size_t c = 0; c < SLAB_CLASSES; ++c)
+	pthread_mutex_destroy(&arena->classes[c].lock);
+}
+
+/* one object out of the class, cls->lock held */
+static void *slab_class_take(SlabClass *cls, size_t obj_size){
+    SlabObj *obj = cls->free;
+    if(obj){
+	cls->free = obj->next;
+	return obj;
+    }
+
+    if(cls->bump + obj_size > cls->end){
+	char *slab = malloc(SLAB_BYTES);
+	if(!slab) return NULL;
+	*(void **) slab = cls->slabs;
+	cls->slabs = slab;
+	/* the link word takes the first 16 bytes, objects stay 16-byte aligned */
+	cls->bump = slab + 16;
+	cls->end = slab + SLAB_BYTES;
+    }
+    void *ret = cls->bump;
+    cls->bump += obj_size;
+    return ret;
+}
+
+void *slab_alloc(SlabArena *arena, size_t size){
+    if(size > SLAB_MAX_SIZE)
+	return NULL;
+
+    unsigned int c = slab_class_of[(size + 15) / 16];
+    SlabClass *cls = &arena->classes[c];
+    SlabTCache *tc = slab_tcache(arena);
+
+    if(tc && tc[c].head){
+	SlabObj *obj = tc[c].head;
+	tc[c].head = obj->next;
+	tc[c].count--;
+	return obj;
+    }
+
+    pthread_mutex_lock(&cls->lock);
+    void *ret = slab_class_take(cls, slab_class_size[c]);
+    /* refill, so the next allocations stay off the lock */
+    if(tc && ret){
+	for(size_t i = 0; i < SLAB_TCACHE_BATCH; ++i){
+	    SlabObj *obj = slab_class_take(cls, slab_class_size[c]);
+	    if(!obj) break;
+	    obj->next = tc[c].head;
+	    tc[c].head = obj;
+	    tc[c].count++;
+	}
+    }
+    pthread_mutex_unlock(&cls->lock);
+    return ret;
+}
+
+void slab_free(SlabArena *arena, void *ptr, size_t size){
+    if(!ptr)
+	return;
+
+    unsigned int c = slab_class_of[(size + 15) / 16];
+    SlabClass *cls = &arena->classes[c];
+    SlabTCache *tc = slab_tcache(arena);
+    SlabObj *obj = ptr;
+
+    if(tc){
+	obj->next = tc[c].head;
+	tc[c].head = obj;
+	if(++tc[c].count <= SLAB_TCACHE_MAX)
+	    return;
+
+	/* too many parked here, hand a batch back to the other threads */
+	SlabObj *first = tc[c].head, *last = first;
+	for(size_t i = 1; i < SLAB_TCACHE_BATCH; ++i)
+	    last = last->next;
+	tc[c].head = last->next;
+	tc[c].count -= SLAB_TCACHE_BATCH;
+
+	pthread_mutex_lock(&cls->lock);
+	last->next = cls->free;
+	cls->free = first;
+	pthread_mutex_unlock(&cls->lock);
+	return;
+    }
+
+    pthread_mutex_lock(&cls->lock);
+    obj->next = cls->free;
+    cls->free = obj;
+    pthread_mutex_unlock(&cls->lock);
+}
@@ -0,0 +1,85 @@
+#ifndef	    SLAB_H
+#define	    SLAB_H
+
+#include    <stddef.h>
+#include    <stdlib.h>
+#include    <stdalign.h>
+#include    <pthread.h>
+
+#define	    SLAB_BYTES		(64u << 10)	/* one block carved into objects of one class */
+#define	    SLAB_CLASSES	8u		/* 16 32 48 64 96 128 192 256 bytes */
+#define	    SLAB_MAX_SIZE	256u
+#define	    SLAB_MAX_THREADS	64u		/* live threads past this share the locked path */
+#define	    SLAB_TCACHE_MAX	64u		/* objects a thread keeps per class */
+#define	    SLAB_TCACHE_BATCH	32u		/* objects moved between a thread and the arena at once */
+
+/**
+ * Node allocator hook. A container that opts in allocates and frees its nodes
+ * through one of these instead of malloc/free; NULL keeps plain malloc. free gets
+ * the size back, so an allocator needs no per-object header. release, when set,
+ * frees every object at once and leaves the allocator ready for reuse; a
+ * container may call it from its destroy instead of walking its nodes.
+ */
+typedef struct node_allocator NodeAllocator;
+struct node_allocator {
+    void *(*alloc)(NodeAllocator *a, size_t size);
+    void (*free)(NodeAllocator *a, void *ptr, size_t size);
+    void (*release)(NodeAllocator *a);
+};
+
+static inline void *node_alloc(NodeAllocator *a, size_t size){
+    return a ? a->alloc(a, size) : malloc(size);
+}
+
+static inline void node_free(NodeAllocator *a, void *ptr, size_t size){
+    if(a)
+	a->free(a, ptr, size);
+    else
+	free(ptr);
+}
+
+/**
+ * Size-class slab arena, one per structure. Objects are carved out of 64 KiB
+ * slabs, so nodes allocated together sit together and carry no malloc header.
+ * Every thread keeps a small free list per class inside the arena and only
+ * takes the class lock to move a batch in or out. slab_arena_destroy hands back
+ * all slabs at once, which replaces walking the structure to free it node by node.
+ */
+typedef struct slab_obj {
+    struct slab_obj *next;
+} SlabObj;
+
+typedef struct slab_class {
+    pthread_mutex_t lock;
+    SlabObj *free;          /* objects given back by threads */
+    char *bump;             /* untouched part of the newest slab */
+    char *end;
+    void *slabs;            /* every slab of this class, linked through its first word */
+} SlabClass;
+
+typedef struct slab_tcache {
+    SlabObj *head;
+    size_t count;
+} SlabTCache;
+
+typedef struct slab_thread_row {
+    alignas(64) SlabTCache cache[SLAB_CLASSES];
+} SlabThreadRow;
+
+typedef struct slab_arena {
+    NodeAllocator base;     /* pass &arena->base to a container */
+    SlabClass classes[SLAB_CLASSES];
+    SlabThreadRow threads[SLAB_MAX_THREADS];
+} SlabArena;
+
+int slab_arena_init(SlabArena *arena);
+
+void slab_arena_destroy(SlabArena *arena);      /* frees every object at once, no thread may still use it */
+
+void slab_arena_reset(SlabArena *arena);        /* same, but the arena stays usable; base.release calls this */
+
+void *slab_alloc(SlabArena *arena, size_t size);   /* NULL if size > SLAB_MAX_SIZE */
+
+void slab_free(SlabArena *arena, void *ptr, size_t size);
+
+#endif
@@ -0,0 +1,98 @@
+/* BSTree nodes from malloc vs a slab arena: raw alloc/free, then insert, lookup and destroy */
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <time.h>
+#include    "bst.h"
+#include    "../alloc/slab.h"
+
+#define	    NKEYS	(1u << 20)
+#define	    ROUNDS	4u
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* NKEYS node-sized objects out, then all back in, ROUNDS times: ns per alloc + free */
+static double churn(NodeAllocator *a, void **objs){
+    double start = now_sec();
+    for(size_t r = 0; r < ROUNDS; ++r){
+	for(size_t i = 0; i < NKEYS; ++i)
+	    objs[i] = node_alloc(a, sizeof(BST));
+	for(size_t i = 0; i < NKEYS; ++i)
+	    node_free(a, objs[i], sizeof(BST));
+    }
+    return (now_sec() - start) / ((double) ROUNDS * NKEYS) * 1e9;
+}
+
+typedef struct tree_times {
+    double insert;
+    double lookup;
+    double destroy;
+} TreeTimes;
+
+static TreeTimes tree_run(NodeAllocator *a, const int *keys){
+    TreeTimes t;
+    BSTree tree;
+    size_t hits = 0;
+    double start;
+
+    BSTree_init(&tree, BST_DFT_DEAD_RATIO);
+    tree.alloc = a;
+
+    start = now_sec();
+    for(size_t i = 0; i < NKEYS; ++i)
+	BSTree_insert(&tree, keys[i]);
+    t.insert = (now_sec() - start) / NKEYS * 1e9;
+
+    start = now_sec();
+    for(size_t i = 0; i < NKEYS; ++i)
+	hits += BST_contains(&tree.root, keys[NKEYS - 1 - i]);
+    t.lookup = (now_sec() - start) / NKEYS * 1e9;
+    if(hits != NKEYS)
+	printf("lost keys: %zu\n", NKEYS - hits);
+
+    start = now_sec();
+    BSTree_destruct(&tree);
+    t.destroy = (now_sec() - start) / NKEYS * 1e9;
+    return t;
+}
+
+int main(){
+    int *keys = malloc(NKEYS * sizeof(int));
+    void **objs = malloc(NKEYS * sizeof(void *));
+    unsigned int seed = 1;
+    SlabArena arena;
+
+    if(!keys || !objs || slab_arena_init(&arena) < 0) return 1;
+    for(size_t i = 0; i < NKEYS; ++i)
+	keys[i] = i;
+    for(size_t i = NKEYS - 1; i > 0; --i){
+	size_t j = rand_r(&seed) % (i + 1);
+	int tmp = keys[i];
+	keys[i] = keys[j];
+	keys[j] = tmp;
+    }
+
+    double c_malloc = churn(NULL, objs);
+    double c_slab = churn(&arena.base, objs);
+    slab_arena_reset(&arena);
+
+    TreeTimes t_malloc = tree_run(NULL, keys);
+    /* the tree owns the arena, so its destroy is one release of the slabs */
+    TreeTimes t_slab = tree_run(&arena.base, keys);
+
+    printf("%u keys, %zu-byte nodes, ns per node\n", NKEYS, sizeof(BST));
+    printf("%-14s %10s %10s\n", "", "malloc", "slab");
+    printf("%-14s %10.1f %10.1f\n", "alloc + free", c_malloc, c_slab);
+    printf("%-14s %10.1f %10.1f\n", "insert", t_malloc.insert, t_slab.insert);
+    printf("%-14s %10.1f %10.1f\n", "lookup", t_malloc.lookup, t_slab.lookup);
+    printf("%-14s %10.1f %10.1f\n", "destroy", t_malloc.destroy, t_slab.destroy);
+
+    slab_arena_destroy(&arena);
+    free(keys);
+    free(objs);
+    return 0;
+}
@@ -1,5 +1,7 @@
 #include    <stdio.h>
 #include    <stdlib.h>
+#include    <limits.h>
+#include    <stdint.h>
 #include    "bst.h"
 #include    "ring_buf.h"
 
@@ -8,57 +10,289 @@ void BST_init(BST **root){
     return;
 }
 
-BST *BST_node_new(int data){
-    BST *new_node = malloc(sizeof(BST));
+/* plain BST calls pass a = NULL, a BSTree passes its own allocator */
+static BST *bst_node_new(NodeAllocator *a, int data){
+    BST *new_node = node_alloc(a, sizeof(BST));
     if(!new_node) return NULL;
     // invariant: new_node is successfully malloc
     new_node->data = data;
     new_node->left_node = NULL;
     new_node->right_node = NULL;
+    new_node->count = 1;
     new_node->deleted = 0;
+    new_node->block = BST_OWN_NODE;
     
     return new_node;
 }
 
-int BST_insert(BST **root, int data){
+BST *BST_node_new(int data){
+    return bst_node_new(NULL, data);
+}
+
+/* nodes inside a block go with it */
+static void bst_node_release(NodeAllocator *a, BST *node){
+    if(node->block == BST_OWN_NODE)
+	node_free(a, node, sizeof(BST));
+    else if(node->block == BST_BLOCK_HEAD)
+	free(node);
+}
+
+/* pre-order: the subtree over sorted[lo, hi) takes block[*next ..] */
+static BST *bst_bulk_build(BST *block, size_t *next, const int *sorted, size_t lo, size_t hi){
+    if(lo >= hi) return NULL;
+    size_t mid = lo + (hi - lo) / 2;
+    BST *node = &block[(*next)++];
+    node->data = sorted[mid];
+    node->count = hi - lo;
+    node->deleted = 0;
+    node->block = BST_BLOCK_NODE;
+    node->left_node = bst_bulk_build(block, next, sorted, lo, mid);
+    node->right_node = bst_bulk_build(block, next, sorted, mid + 1, hi);
+    return node;
+}
+
+BST *BST_bulk_load(const int *sorted, size_t n){
+    if(!n) return NULL;
+    for(size_t i = 1; i < n; ++i)
+	if(sorted[i - 1] >= sorted[i])
+	    return NULL;
+
+    BST *block = malloc(n * sizeof(BST));
+    if(!block) return NULL;
+    size_t next = 0;
+    bst_bulk_build(block, &next, sorted, 0, n);
+    block->block = BST_BLOCK_HEAD;
+    return block;
+}
+
+/* live keys of root in order into a malloc'ed array */
+static int bst_collect(BST *root, int **keys, size_t *n){
+    BSTIter it;
+    size_t cap = 0;
+    BST *node;
+
+    *keys = NULL;
+    *n = 0;
+    if(BST_iter_init(&it, &root) < 0) return ERR_MALLOC_FAILED;
+    while((node = BST_iter_next(&it))){
+	if(*n == cap){
+	    size_t new_cap = cap ? cap << 1u : 64u;
+	    int *tmp = realloc(*keys, new_cap * sizeof(int));
+	    if(!tmp) goto fail;
+	    *keys = tmp;
+	    cap = new_cap;
+	}
+	(*keys)[(*n)++] = node->data;
+    }
+    if(it.failed) goto fail;
+    BST_iter_destruct(&it);
+    return 0;
+
+fail:
+    BST_iter_destruct(&it);
+    free(*keys);
+    *keys = NULL;
+    return ERR_MALLOC_FAILED;
+}
+
+int BST_bulk_merge(BST **root, const int *sorted, size_t n){
+    int *keys, *merged;
+    size_t nkeys, len = 0, i = 0, j = 0;
+
+    for(size_t k = 1; k < n; ++k)
+	if(sorted[k - 1] >= sorted[k])
+	    return ERR_DATA_EXISTS;
+    if(bst_collect(*root, &keys, &nkeys) < 0)
+	return ERR_MALLOC_FAILED;
+    merged = malloc((nkeys + n ? nkeys + n : 1) * sizeof(int));
+    if(!merged){
+	free(keys);
+	return ERR_MALLOC_FAILED;
+    }
+
+    while(i < nkeys || j < n){
+	if(j == n || (i < nkeys && keys[i] < sorted[j]))
+	    merged[len++] = keys[i++];
+	else if(i == nkeys || sorted[j] < keys[i])
+	    merged[len++] = sorted[j++];
+	else {
+	    merged[len++] = keys[i++];
+	    j++;
+	}
+    }
+    free(keys);
+
+    BST *fresh = BST_bulk_load(merged, len);
+    free(merged);
+    if(!fresh && len)
+	return ERR_MALLOC_FAILED;
+    BST_destruct(root);
+    *root = fresh;
+    return 0;
+}
+
+/* one in-flight lookup of BST_search_batch */
+typedef struct bst_lookup {
+    BST *node;
+    size_t idx;
+} BSTLookup;
+
+size_t BST_search_batch(BST **root, const int *keys, size_t n, int *out){
+    BSTLookup group[BST_BATCH_GROUP];
+    size_t active = 0, next = 0, found = 0;
+
+    while(active < BST_BATCH_GROUP && next < n)
+	group[active++] = (BSTLookup){ .node = *root, .idx = next++ };
+
+    while(active){
+	for(size_t i = 0; i < active; ){
+	    BSTLookup *l = &group[i];
+	    BST *node = l->node;
+	    int key = keys[l->idx];
+
+	    if(!node || node->data == key){
+		int hit = node && !node->deleted;
+		out[l->idx] = hit ? 0 : ERR_DATA_NOT_FOUND;
+		found += hit;
+		/* the slot takes the next key, or the last slot fills the hole */
+		if(next < n){
+		    *l = (BSTLookup){ .node = *root, .idx = next++ };
+		    ++i;
+		} else
+		    *l = group[--active];
+		continue;
+	    }
+
+	    node = key > node->data ? node->right_node : node->left_node;
+	    __builtin_prefetch(node);
+	    l->node = node;
+	    ++i;
+	}
+    }
+    return found;
+}
+
+int BST_contains(BST **root, int data){
+    BST *node = *root;
+    while(node && node->data != data)
+	node = data > node->data ? node->right_node : node->left_node;
+    return node && !node->deleted;
+}
+
+/* add delta to the count of every node above data, or above where it would go */
+static void bst_count_path(BST *node, int data, int delta){
+    while(node && node->data != data){
+	node->count += delta;
+	node = data > node->data ? node->right_node : node->left_node;
+    }
+}
+
+/* 0 for a new node, 1 if a tombstone was revived; counts are bumped on the way down and undone on failure */
+static int bst_insert(BST **root, int data, NodeAllocator *a){
     BST **node = root;
 
     while(*node){
-	if(data == (*node)->data)
-	  return ERR_DATA_EXISTS;
-	else if(data > (*node)->data)
+	if(data == (*node)->data){
+	    if(!(*node)->deleted){
+		bst_count_path(*root, data, -1);
+		return ERR_DATA_EXISTS;
+	    }
+	    (*node)->deleted = 0;
+	    (*node)->count++;
+	    return 1;
+	}
+	(*node)->count++;
+	if(data > (*node)->data)
 	  node = &(*node)->right_node;
 	else
 	  node = &(*node)->left_node;
     }
-    *node = BST_node_new(data);
+    *node = bst_node_new(a, data);
+    if(!*node){
+	bst_count_path(*root, data, -1);
+	return ERR_MALLOC_FAILED;
+    }
 
     return 0;
 }
 
+int BST_insert(BST **root, int data){
+    int ret = bst_insert(root, data, NULL);
+    return ret < 0 ? ret : 0;
+}
+
 int BST_delete(BST **root, int data){
    BST *node = *root; 
     
    while(node){
 	if(node->data == data){
+	    if(node->deleted)
+		break;
 	    node->deleted = 1;
+	    node->count--;
 	    return 0;
 	}
 	//invariant: the data is not in BST	
+	node->count--;
 	if(data > node->data)
 	  node = node->right_node;
 	else 
 	  node = node->left_node;
    }
    
+   bst_count_path(*root, data, 1);
    return ERR_DATA_NOT_FOUND;
 }
 
+static size_t bst_count(BST *node){
+    return node ? node->count : 0;
+}
+
+/* live keys < data, or <= data if inclusive */
+static size_t bst_rank(BST *node, int data, int inclusive){
+    size_t rank = 0;
+    while(node){
+	if(data > node->data || (inclusive && data == node->data)){
+	    rank += bst_count(node->left_node) + !node->deleted;
+	    node = node->right_node;
+	} else
+	    node = node->left_node;
+    }
+    return rank;
+}
+
+size_t BST_rank(BST **root, int data){
+    return bst_rank(*root, data, 0);
+}
+
+BST *BST_select(BST **root, size_t k){
+    BST *node = *root;
+    while(node){
+	size_t left = bst_count(node->left_node);
+	if(k < left){
+	    node = node->left_node;
+	} else if(k == left && !node->deleted){
+	    return node;
+	} else {
+	    k -= left + !node->deleted;
+	    node = node->right_node;
+	}
+    }
+    return NULL;
+}
+
+size_t BST_count_range(BST **root, int lo, int hi){
+    if(lo > hi) return 0;
+    return bst_rank(*root, hi, 1) - bst_rank(*root, lo, 0);
+}
+
 int BST_search(BST **root, int data){
     BST *node = *root;
     
     while(node){
 	if(data == node->data){
+	    if(node->deleted)
+		return ERR_DATA_NOT_FOUND;
 	    printf("Found: %d\n", data);
 	    return 0;
 	} else if(data > node->data)
@@ -70,43 +304,182 @@ int BST_search(BST **root, int data){
     return ERR_DATA_NOT_FOUND;
 }
 
+/* rotate left children up until the top has none, then free it: no stack at all */
+static void bst_destruct(BST **root, NodeAllocator *a){
+    BST *node = *root, *blocks = NULL;
+
+    while(node){
+	if(node->left_node){
+	    BST *left = node->left_node;
+	    node->left_node = left->right_node;
+	    left->right_node = node;
+	    node = left;
+	} else {
+	    BST *right = node->right_node;
+	    /* the rest of a block may still be ahead, keep it until the end */
+	    if(node->block == BST_BLOCK_HEAD){
+		node->left_node = blocks;
+		blocks = node;
+	    } else {
+		bst_node_release(a, node);
+	    }
+	    node = right;
+	}
+    }
+    while(blocks){
+	BST *head = blocks;
+	blocks = head->left_node;
+	free(head);
+    }
+}
+
 void BST_destruct(BST **root){
-    BST *node = *root;
-    if(!node) return;
-    //invariant: node is not NULL
-    BST_destruct(&node->left_node);
-    BST_destruct(&node->right_node);
-    free(node);
+    bst_destruct(root, NULL);
 }
 
-void BST_pre_order_traversal(BST **root){
-    BST *node = *root;
-    if(!node) return;
-    // invariant: node is not NULL
+/* sorted keys into the Eytzinger slots of the subtree at k, in order */
+static size_t bst_eytzinger_fill(int *out, size_t n, const int *sorted, size_t next, size_t k){
+    if(k > n) return next;
+    next = bst_eytzinger_fill(out, n, sorted, next, 2 * k);
+    out[k] = sorted[next++];
+    return bst_eytzinger_fill(out, n, sorted, next, 2 * k + 1);
+}
+
+int BST_freeze(BST **root, BSTFrozen *fz){
+    int *sorted, *keys;
+    size_t n;
+
+    if(bst_collect(*root, &sorted, &n) < 0)
+	return ERR_MALLOC_FAILED;
+
+    /* slot 0 is unused; aligned_alloc wants a multiple of the alignment */
+    size_t bytes = ((n + 1) * sizeof(int) + 63) & ~(size_t) 63;
+    keys = aligned_alloc(64, bytes);
+    if(!keys){
+	free(sorted);
+	return ERR_MALLOC_FAILED;
+    }
+    bst_eytzinger_fill(keys, n, sorted, 0, 1);
+    free(sorted);
+
+    free(fz->keys);
+    fz->keys = keys;
+    fz->n = n;
+    return 0;
+}
+
+void BST_frozen_destruct(BSTFrozen *fz){
+    free(fz->keys);
+    fz->keys = NULL;
+    fz->n = 0;
+}
+
+/**
+ * walk down with k = 2k + (keys[k] < data) until k runs off the tree, then
+ * strip the trailing right turns plus the last left turn: what remains is
+ * the last node where the walk went left, the first key not below data.
+ * strict selects upper_bound (keys[k] <= data goes right as well).
+ */
+static size_t bst_frozen_bound(const BSTFrozen *fz, int data, int strict){
+    const int *keys = fz->keys;
+    size_t k = 1;
+
+    while(k <= fz->n){
+	/* in the last four levels the line would lie past keys[n], nothing to fetch */
+	if(k * BST_FROZEN_PREFETCH <= fz->n)
+	    __builtin_prefetch(keys + k * BST_FROZEN_PREFETCH);
+	k = 2 * k + (strict ? keys[k] <= data : keys[k] < data);
+    }
+    k >>= __builtin_ctzl(~k) + 1;
+    return k;
+}
+
+int BST_frozen_search(const BSTFrozen *fz, int data){
+    size_t k = bst_frozen_bound(fz, data, 0);
+    return k && fz->keys[k] == data ? 0 : ERR_DATA_NOT_FOUND;
+}
+
+const int *BST_frozen_lower_bound(const BSTFrozen *fz, int data){
+    size_t k = bst_frozen_bound(fz, data, 0);
+    return k ? &fz->keys[k] : NULL;
+}
+
+const int *BST_frozen_upper_bound(const BSTFrozen *fz, int data){
+    size_t k = bst_frozen_bound(fz, data, 1);
+    return k ? &fz->keys[k] : NULL;
+}
+
+static void bst_print_visit(BST *node, void *arg){
+    (void) arg;
     if(!node->deleted)
 	printf("%d\n", node->data);
-    BST_pre_order_traversal(&node->left_node);
-    BST_pre_order_traversal(&node->right_node);
+}
+
+void BST_pre_order_traversal(BST **root){
+    BST_pre_order_visit(root, bst_print_visit, NULL);
 }
 
 void BST_post_order_traversal(BST **root){
-    BST *node = *root;
-    if(!node) return;
-    // invariant: node is not NULL
-    BST_post_order_traversal(&(node->left_node));
-    BST_post_order_traversal(&(node->right_node));
-    if(!node->deleted)
-        printf("%d\n", node->data);
+    BST_post_order_visit(root, bst_print_visit, NULL);
 }
 
 void BST_in_order_traversal(BST **root){
+    BST_in_order_visit(root, bst_print_visit, NULL);
+}
+
+int BST_iter_init(BSTIter *it, BST **root){
+    it->cursor = *root;
+    it->hi = INT_MAX;
+    it->failed = 0;
+    return seg_stack_init(&it->path);
+}
+
+/* push the ancestors whose key is >= lo, as if the walk had just passed lo */
+int BST_range_iter_init(BSTIter *it, BST **root, int lo, int hi){
     BST *node = *root;
-    if(!node) return;
-    // invariant: node is not NULL
-    BST_in_order_traversal(&node->left_node);
-    if(!node->deleted)
-	 printf("%d\n", node->data);
-    BST_in_order_traversal(&node->right_node);
+
+    if(seg_stack_init(&it->path) < 0) return ERR_MALLOC_FAILED;
+    it->cursor = NULL;
+    it->hi = hi;
+    it->failed = 0;
+    while(node){
+	if(node->data >= lo){
+	    if(seg_stack_push(&it->path, node) < 0){
+		it->failed = 1;
+		return ERR_MALLOC_FAILED;
+	    }
+	    node = node->left_node;
+	} else
+	    node = node->right_node;
+    }
+    return 0;
+}
+
+BST *BST_iter_next(BSTIter *it){
+    for(;;){
+	while(it->cursor){
+	    if(seg_stack_push(&it->path, it->cursor) < 0){
+		it->failed = 1;
+		return NULL;
+	    }
+	    it->cursor = it->cursor->left_node;
+	}
+
+	void *top;
+	if(seg_stack_pop(&it->path, &top) < 0)
+	    return NULL;
+	BST *node = top;
+	/* whatever is still pending is larger too */
+	if(node->data > it->hi)
+	    return NULL;
+	it->cursor = node->right_node;
+	if(!node->deleted)
+	    return node;
+    }
+}
+
+void BST_iter_destruct(BSTIter *it){
+    seg_stack_destruct(&it->path);
 }
 
 void BST_level_traversal(BST **root){
@@ -134,3 +507,414 @@ void BST_level_traversal(BST **root){
 
     return;
 }
+
+enum {
+    PRE_ORDER,
+    IN_ORDER,
+    POST_ORDER
+};
+
+typedef struct bst_walk {
+    TaskPool *pool;
+    BST *node;
+    BST_visit_fn visit;
+    void *arg;
+    int order;
+    unsigned int depth;
+} BSTWalk;
+
+#define	    WALK_DONE	1u	/* post order stack entry: children already pushed, visit next */
+
+/* sequential walk on an explicit stack, so a skewed tree cannot overflow the call stack */
+static int bst_walk_seq(BST *node, int order, BST_visit_fn visit, void *arg){
+    SegStack path;
+    void *top;
+
+    if(!node) return 0;
+    if(seg_stack_init(&path) < 0) return ERR_MALLOC_FAILED;
+
+    if(order == IN_ORDER){
+	while(node || !seg_stack_isempty(&path)){
+	    if(node){
+		if(seg_stack_push(&path, node) < 0) goto fail;
+		node = node->left_node;
+		continue;
+	    }
+	    seg_stack_pop(&path, &top);
+	    node = top;
+	    BST *right = node->right_node;
+	    visit(node, arg);
+	    node = right;
+	}
+	seg_stack_destruct(&path);
+	return 0;
+    }
+
+    if(seg_stack_push(&path, node) < 0) goto fail;
+    while(!seg_stack_isempty(&path)){
+	seg_stack_pop(&path, &top);
+	uintptr_t entry = (uintptr_t) top;
+	node = (BST *) (entry & ~(uintptr_t) WALK_DONE);
+	if(entry & WALK_DONE){
+	    visit(node, arg); /* children are done, visit may free node */
+	    continue;
+	}
+
+	BST *left = node->left_node;
+	BST *right = node->right_node;
+	if(order == PRE_ORDER)
+	    visit(node, arg);
+	else if(seg_stack_push(&path, (void *) (entry | WALK_DONE)) < 0)
+	    goto fail;
+	if(right && seg_stack_push(&path, right) < 0) goto fail;
+	if(left && seg_stack_push(&path, left) < 0) goto fail;
+    }
+    seg_stack_destruct(&path);
+    return 0;
+
+fail:
+    seg_stack_destruct(&path);
+    return ERR_MALLOC_FAILED;
+}
+
+static void bst_walk_par(void *walk_arg){
+    BSTWalk *w = walk_arg;
+    BST *node = w->node;
+    if(!node) return;
+
+    /* deep enough that there are plenty of tasks, finish the subtree here */
+    if(w->depth >= BST_PAR_SPAWN_DEPTH){
+	bst_walk_seq(node, w->order, w->visit, w->arg);
+	return;
+    }
+
+    BSTWalk left = *w, right = *w;
+    Task task;
+    left.node = node->left_node;
+    left.depth++;
+    right.node = node->right_node;
+    right.depth++;
+
+    if(w->order == PRE_ORDER)
+	w->visit(node, w->arg);
+
+    if(w->order == IN_ORDER){
+	/* only the left subtree has to come first, the right one runs meanwhile */
+	task_spawn(w->pool, &task, bst_walk_par, &right);
+	bst_walk_par(&left);
+	w->visit(node, w->arg);
+	task_sync(w->pool, &task);
+    } else {
+	task_spawn(w->pool, &task, bst_walk_par, &left);
+	bst_walk_par(&right);
+	task_sync(w->pool, &task);
+    }
+
+    if(w->order == POST_ORDER)
+	w->visit(node, w->arg);
+}
+
+static void bst_walk(BST **root, TaskPool *pool, int order, BST_visit_fn visit, void *arg){
+    BSTWalk w = {
+	.pool = pool,
+	.node = *root,
+	.visit = visit,
+	.arg = arg,
+	.order = order,
+	.depth = 0
+    };
+    bst_walk_par(&w);
+}
+
+static void bst_free_visit(BST *node, void *arg){
+    (void) arg;
+    bst_node_release(NULL, node);
+}
+
+void BST_destruct_parallel(BST **root, TaskPool *pool){
+    bst_walk(root, pool, POST_ORDER, bst_free_visit, NULL);
+    *root = NULL;
+}
+
+void BST_pre_order_traversal_parallel(BST **root, TaskPool *pool, BST_visit_fn visit, void *arg){
+    bst_walk(root, pool, PRE_ORDER, visit, arg);
+}
+
+void BST_post_order_traversal_parallel(BST **root, TaskPool *pool, BST_visit_fn visit, void *arg){
+    bst_walk(root, pool, POST_ORDER, visit, arg);
+}
+
+void BST_in_order_traversal_parallel(BST **root, TaskPool *pool, BST_visit_fn visit, void *arg){
+    bst_walk(root, pool, IN_ORDER, visit, arg);
+}
+
+int BST_pre_order_visit(BST **root, BST_visit_fn visit, void *arg){
+    return bst_walk_seq(*root, PRE_ORDER, visit, arg);
+}
+
+int BST_in_order_visit(BST **root, BST_visit_fn visit, void *arg){
+    return bst_walk_seq(*root, IN_ORDER, visit, arg);
+}
+
+int BST_post_order_visit(BST **root, BST_visit_fn visit, void *arg){
+    return bst_walk_seq(*root, POST_ORDER, visit, arg);
+}
+
+enum {
+    REBUILD_COLLECT,	/* in-order walk of the old tree, live keys into keys[] */
+    REBUILD_BUILD,	/* balanced tree from keys[], midpoint first */
+    REBUILD_REPLAY,	/* updates made since the rebuild started, onto the new tree */
+    REBUILD_FREE	/* new tree is in use, old nodes are freed */
+};
+
+/* an insert/delete that changed the tree while the rebuild was running */
+typedef struct bst_log_entry {
+    int data;
+    _Bool deleted;
+} BSTLogEntry;
+
+/* keys[lo, hi) still to be built into *slot */
+typedef struct bst_range {
+    size_t lo;
+    size_t hi;
+    BST **slot;
+} BSTRange;
+
+struct bst_rebuild {
+    int phase;
+    SegStack path;		/* collect: ancestors still to be visited */
+    BST *cursor;		/* collect: subtree to descend next */
+    int *keys;
+    size_t nkeys;
+    size_t keys_cap;
+    BSTRange ranges[sizeof(size_t) * CHAR_BIT + 1];	/* build: one pending right range per level */
+    size_t nranges;
+    BST *fresh;
+    size_t fresh_dead;
+    BSTLogEntry *log;
+    size_t log_len;
+    size_t log_cap;
+    size_t log_pos;
+    BST *old;			/* free: what is left of the old tree */
+    BST *blocks;		/* free: block heads, linked by left_node, freed last */
+};
+
+void BSTree_init(BSTree *tree, double dead_ratio){
+    tree->root = NULL;
+    tree->live = 0;
+    tree->dead = 0;
+    tree->dead_ratio = dead_ratio > 0 ? dead_ratio : BST_DFT_DEAD_RATIO;
+    tree->rebuild = NULL;
+    tree->alloc = NULL;
+}
+
+static int bst_grow(void **buf, size_t *cap, size_t elem_size){
+    size_t new_cap = *cap ? *cap << 1u : 64u;
+    void *tmp = realloc(*buf, new_cap * elem_size);
+    if(!tmp) return ERR_MALLOC_FAILED;
+    *buf = tmp;
+    *cap = new_cap;
+    return 0;
+}
+
+static void bst_rebuild_release(BSTree *tree){
+    BSTRebuild *rb = tree->rebuild;
+    while(rb->blocks){
+	BST *head = rb->blocks;
+	rb->blocks = head->left_node;
+	free(head);
+    }
+    seg_stack_destruct(&rb->path);
+    free(rb->keys);
+    free(rb->log);
+    free(rb);
+    tree->rebuild = NULL;
+}
+
+/* drop a rebuild that has not been swapped in yet, the old tree is still complete */
+static void bst_rebuild_abort(BSTree *tree){
+    bst_destruct(&tree->rebuild->fresh, tree->alloc);
+    bst_rebuild_release(tree);
+}
+
+static void bst_rebuild_start(BSTree *tree){
+    BSTRebuild *rb = calloc(1, sizeof(BSTRebuild));
+    if(!rb) return;
+    if(seg_stack_init(&rb->path) < 0){
+	free(rb);
+	return;
+    }
+    rb->phase = REBUILD_COLLECT;
+    rb->cursor = tree->root;
+    tree->rebuild = rb;
+}
+
+/* one unit of rebuild work, < 0 if the rebuild had to be dropped */
+static int bst_rebuild_step(BSTree *tree){
+    BSTRebuild *rb = tree->rebuild;
+
+    switch(rb->phase){
+	case REBUILD_COLLECT:
+	  if(rb->cursor){
+	      if(seg_stack_push(&rb->path, rb->cursor) < 0)
+		  return ERR_MALLOC_FAILED;
+	      rb->cursor = rb->cursor->left_node;
+	  } else if(!seg_stack_isempty(&rb->path)){
+	      void *top;
+	      seg_stack_pop(&rb->path, &top);
+	      BST *node = top;
+	      if(!node->deleted){
+		  if(rb->nkeys == rb->keys_cap &&
+			  bst_grow((void **) &rb->keys, &rb->keys_cap, sizeof(int)) < 0)
+		      return ERR_MALLOC_FAILED;
+		  rb->keys[rb->nkeys++] = node->data;
+	      }
+	      rb->cursor = node->right_node;
+	  } else {
+	      rb->phase = REBUILD_BUILD;
+	      if(rb->nkeys)
+		  rb->ranges[rb->nranges++] = (BSTRange){ .lo = 0, .hi = rb->nkeys, .slot = &rb->fresh };
+	  }
+	  return 0;
+
+	case REBUILD_BUILD:
+	  if(rb->nranges){
+	      BSTRange r = rb->ranges[--rb->nranges];
+	      size_t mid = r.lo + (r.hi - r.lo) / 2;
+	      BST *node = bst_node_new(tree->alloc, rb->keys[mid]);
+	      if(!node) return ERR_MALLOC_FAILED;
+	      node->count = r.hi - r.lo;
+	      *r.slot = node;
+	      if(mid + 1 < r.hi)
+		  rb->ranges[rb->nranges++] = (BSTRange){ .lo = mid + 1, .hi = r.hi, .slot = &node->right_node };
+	      if(r.lo < mid)
+		  rb->ranges[rb->nranges++] = (BSTRange){ .lo = r.lo, .hi = mid, .slot = &node->left_node };
+	  } else {
+	      rb->phase = REBUILD_REPLAY;
+	  }
+	  return 0;
+
+	case REBUILD_REPLAY:
+	  if(rb->log_pos < rb->log_len){
+	      BSTLogEntry *e = &rb->log[rb->log_pos++];
+	      if(e->deleted){
+		  if(BST_delete(&rb->fresh, e->data) == 0)
+		      rb->fresh_dead++;
+	      } else {
+		  int ret = bst_insert(&rb->fresh, e->data, tree->alloc);
+		  if(ret == ERR_MALLOC_FAILED)
+		      return ret;
+		  if(ret == 1)
+		      rb->fresh_dead--;
+	      }
+	  } else {
+	      /* the new tree now holds exactly the live keys, swap it in */
+	      rb->old = tree->root;
+	      tree->root = rb->fresh;
+	      tree->dead = rb->fresh_dead;
+	      rb->fresh = NULL;
+	      rb->phase = REBUILD_FREE;
+	  }
+	  return 0;
+
+	case REBUILD_FREE:
+	  /* rotate left children up until the top has none, then free it: O(1) space */
+	  if(rb->old){
+	      BST *node = rb->old;
+	      if(node->left_node){
+		  BST *left = node->left_node;
+		  node->left_node = left->right_node;
+		  left->right_node = node;
+		  rb->old = left;
+	      } else {
+		  rb->old = node->right_node;
+		  /* the rest of a block may still be ahead, keep it until the end */
+		  if(node->block == BST_BLOCK_HEAD){
+		      node->left_node = rb->blocks;
+		      rb->blocks = node;
+		  } else {
+		      bst_node_release(tree->alloc, node);
+		  }
+	      }
+	  } else {
+	      bst_rebuild_release(tree);
+	  }
+	  return 0;
+    }
+    return 0;
+}
+
+/* called after every successful update */
+static void bst_rebuild_advance(BSTree *tree){
+    size_t total = tree->live + tree->dead;
+
+    if(!tree->rebuild && total >= BST_REBUILD_MIN && tree->dead > tree->dead_ratio * total)
+	bst_rebuild_start(tree);
+
+    for(size_t i = 0; i < BST_REBUILD_STEP && tree->rebuild; ++i){
+	if(bst_rebuild_step(tree) < 0){
+	    bst_rebuild_abort(tree);
+	    return;
+	}
+    }
+}
+
+static void bst_rebuild_log(BSTree *tree, int data, _Bool deleted){
+    BSTRebuild *rb = tree->rebuild;
+    if(!rb || rb->phase == REBUILD_FREE)
+	return;
+    if(rb->log_len == rb->log_cap &&
+	    bst_grow((void **) &rb->log, &rb->log_cap, sizeof(BSTLogEntry)) < 0){
+	/* without the entry the new tree would be wrong */
+	bst_rebuild_abort(tree);
+	return;
+    }
+    rb->log[rb->log_len++] = (BSTLogEntry){ .data = data, .deleted = deleted };
+}
+
+int BSTree_insert(BSTree *tree, int data){
+    int ret = bst_insert(&tree->root, data, tree->alloc);
+    if(ret < 0)
+	return ret;
+
+    tree->live++;
+    if(ret == 1)
+	tree->dead--;
+    bst_rebuild_log(tree, data, 0);
+    bst_rebuild_advance(tree);
+    return 0;
+}
+
+int BSTree_delete(BSTree *tree, int data){
+    int ret = BST_delete(&tree->root, data);
+    if(ret < 0)
+	return ret;
+
+    tree->live--;
+    tree->dead++;
+    bst_rebuild_log(tree, data, 1);
+    bst_rebuild_advance(tree);
+    return 0;
+}
+
+int BSTree_search(BSTree *tree, int data){
+    return BST_search(&tree->root, data);
+}
+
+void BSTree_destruct(BSTree *tree){
+    if(tree->alloc && tree->alloc->release){
+	/* every node came from the allocator, hand them all back without a walk */
+	if(tree->rebuild)
+	    bst_rebuild_release(tree);
+	tree->alloc->release(tree->alloc);
+    } else {
+	if(tree->rebuild){
+	    if(tree->rebuild->phase == REBUILD_FREE)
+		bst_destruct(&tree->rebuild->old, tree->alloc);
+	    bst_rebuild_abort(tree);
+	}
+	bst_destruct(&tree->root, tree->alloc);
+    }
+    tree->root = NULL;
+    tree->live = tree->dead = 0;
+}
@@ -1,27 +1,76 @@
 #ifndef	    BST_H
 #define	    BST_H
 
+#include    "../concurrent/task_pool.h"
+#include    "../alloc/slab.h"
+#include    "../stack/seg_stack.h"
+
 #define	    ERR_DATA_EXISTS	-2
 #define	    ERR_DATA_NOT_FOUND	-3
 
+#define	    BST_PAR_SPAWN_DEPTH	12u	/* below this depth parallel walks stop spawning */
+
+#define	    BST_DFT_DEAD_RATIO	0.5	/* rebuild once half the nodes are tombstones */
+#define	    BST_REBUILD_MIN	64u	/* smaller trees are never rebuilt */
+#define	    BST_REBUILD_STEP	8u	/* rebuild work units done by every insert/delete */
+
+#define	    BST_BATCH_GROUP	16u	/* lookups BST_search_batch keeps in flight */
+
+/* who owns a node's memory */
+enum {
+    BST_OWN_NODE,	/* its own allocation: malloc, or the BSTree allocator */
+    BST_BLOCK_NODE,	/* part of a BST_bulk_load block */
+    BST_BLOCK_HEAD	/* first node of a block, freeing it frees the block */
+};
+
 typedef struct bst BST;
 struct bst {
     BST *left_node;
     BST *right_node;
+    unsigned int count;	/* live nodes in this subtree, for rank and select */
     int data;
     _Bool deleted;
+    unsigned char block;
 };
 
 void BST_init(BST **root);
 
 BST *BST_node_new(int data);
 
-int BST_insert(BST **root, int data);
+/**
+ * perfectly balanced tree over sorted[0..n), strictly ascending, in O(n) and
+ * one allocation: nodes sit in pre-order so a descent to the left reads the
+ * next node in memory. NULL if n is 0, the input is not strictly ascending
+ * or malloc fails. Later inserts add their own nodes as usual.
+ */
+BST *BST_bulk_load(const int *sorted, size_t n);
+
+/* merge a strictly ascending batch into *root and rebuild it with BST_bulk_load, tombstones are dropped */
+int BST_bulk_merge(BST **root, const int *sorted, size_t n);
+
+int BST_insert(BST **root, int data);   /* inserting over a tombstone revives it */
 
-int BST_delete(BST **root, int data);
+int BST_delete(BST **root, int data);   /* marks a tombstone, the node stays in the tree */
 
 int BST_search(BST **root, int data);
 
+/**
+ * out[i] = 0 if keys[i] is live, else ERR_DATA_NOT_FOUND; returns how many were found.
+ * one search is a chain of dependent loads, so BST_BATCH_GROUP of them advance
+ * round-robin (AMAC): each step prefetches the child it moves to and goes on
+ * with the other lookups while that line arrives. Nothing is printed.
+ */
+size_t BST_search_batch(BST **root, const int *keys, size_t n, int *out);
+
+int BST_contains(BST **root, int data);     /* 1 if data is live, BST_search without the printf */
+
+/* order statistics over the live keys, O(height) through the subtree counts */
+size_t BST_rank(BST **root, int data);                  /* live keys < data */
+
+BST *BST_select(BST **root, size_t k);                  /* k-th smallest live key from 0, NULL if k >= count */
+
+size_t BST_count_range(BST **root, int lo, int hi);     /* live keys in [lo, hi] */
+
 void BST_destruct(BST **root);
 
 void BST_pre_order_traversal(BST **root);
@@ -32,4 +81,101 @@ void BST_in_order_traversal(BST **root);
 
 void BST_level_traversal(BST **root);
 
+/**
+ * in-order iterator over the live nodes, on an explicit stack so a skewed
+ * tree cannot overflow the call stack; the tree must not change meanwhile.
+ */
+typedef struct bst_iter {
+    SegStack path;
+    BST *cursor;
+    int hi;		/* stop after this key */
+    _Bool failed;	/* the stack could not grow, BST_iter_next stopped early */
+} BSTIter;
+
+int BST_iter_init(BSTIter *it, BST **root);
+
+/* only the live keys in [lo, hi], seeking to lo costs O(height) */
+int BST_range_iter_init(BSTIter *it, BST **root, int lo, int hi);
+
+BST *BST_iter_next(BSTIter *it);    /* NULL at the end */
+
+void BST_iter_destruct(BSTIter *it);
+
+/**
+ * parallel walks on a task pool, sibling subtrees run concurrently so visit must be thread safe
+ * pre order: node before its subtrees, in order: node after its left subtree,
+ * post order: node after both subtrees (safe to free node in visit)
+ */
+typedef void (*BST_visit_fn)(BST *node, void *arg);
+
+void BST_destruct_parallel(BST **root, TaskPool *pool);
+
+void BST_pre_order_traversal_parallel(BST **root, TaskPool *pool, BST_visit_fn visit, void *arg);
+
+void BST_post_order_traversal_parallel(BST **root, TaskPool *pool, BST_visit_fn visit, void *arg);
+
+void BST_in_order_traversal_parallel(BST **root, TaskPool *pool, BST_visit_fn visit, void *arg);
+
+/* the same walks on the calling thread, without recursion */
+int BST_pre_order_visit(BST **root, BST_visit_fn visit, void *arg);
+
+int BST_in_order_visit(BST **root, BST_visit_fn visit, void *arg);
+
+int BST_post_order_visit(BST **root, BST_visit_fn visit, void *arg);
+
+/**
+ * read-only snapshot of the live keys in Eytzinger (BFS) order: keys[1] is
+ * the root and keys[k] has children keys[2k] and keys[2k + 1]. A search is a
+ * branchless walk down the implicit tree; the 16 descendants four levels
+ * below share one cache line, which is prefetched while the walk goes on.
+ * The snapshot does not follow later changes to the tree, freeze again.
+ */
+#define	    BST_FROZEN_PREFETCH	16u	/* ints per cache line */
+
+typedef struct bst_frozen {
+    int *keys;		/* keys[1..n], cache line aligned */
+    size_t n;
+} BSTFrozen;
+
+int BST_freeze(BST **root, BSTFrozen *fz);     /* fz starts zeroed, a previous snapshot is replaced */
+
+void BST_frozen_destruct(BSTFrozen *fz);
+
+int BST_frozen_search(const BSTFrozen *fz, int data);
+
+const int *BST_frozen_lower_bound(const BSTFrozen *fz, int data);   /* first key >= data, NULL if none */
+
+const int *BST_frozen_upper_bound(const BSTFrozen *fz, int data);   /* first key > data, NULL if none */
+
+/**
+ * tree handle that counts live nodes and tombstones. Once tombstones make up
+ * more than dead_ratio of the nodes, the tree is rebuilt into a perfectly
+ * balanced one without them, online: every later insert/delete does
+ * BST_REBUILD_STEP units of the O(n) work (collect the live keys in order,
+ * build the new tree from them, replay the updates made meanwhile, free the
+ * old nodes), and searches keep using the old tree until the new one is
+ * swapped in, so no single call pays for the whole rebuild.
+ */
+typedef struct bst_rebuild BSTRebuild;
+
+typedef struct bst_tree {
+    BST *root;
+    size_t live;
+    size_t dead;
+    double dead_ratio;
+    BSTRebuild *rebuild;    /* NULL unless a rebuild is in progress */
+    NodeAllocator *alloc;   /* NULL is malloc, set after BSTree_init to opt in */
+} BSTree;
+
+void BSTree_init(BSTree *tree, double dead_ratio);   /* dead_ratio <= 0 picks BST_DFT_DEAD_RATIO */
+
+int BSTree_insert(BSTree *tree, int data);
+
+int BSTree_delete(BSTree *tree, int data);
+
+int BSTree_search(BSTree *tree, int data);
+
+/* an allocator with release (a slab arena) must serve this tree alone, it is released in one go */
+void BSTree_destruct(BSTree *tree);
+
 #endif
@@ -0,0 +1,122 @@
+#include    <stdlib.h>
+#include    "bst_arena.h"
+#include    "../stack/seg_stack.h"
+
+#define	    child(idx)		((idx) & ~BST_ARENA_DELETED)
+#define	    is_deleted(n)	((n)->right & BST_ARENA_DELETED)
+
+_Static_assert(sizeof(BSTANode) == 12, "arena node is meant to be 12 bytes");
+
+int BSTArena_init(BSTArena *t, size_t capacity){
+    if(!capacity)
+	capacity = BST_ARENA_DFT_CAPACITY;
+    if(capacity > BST_ARENA_MAX)
+	capacity = BST_ARENA_MAX;
+    t->nodes = malloc(capacity * sizeof(BSTANode));
+    if(!t->nodes) return ERR_MALLOC_FAILED;
+    t->size = 1;
+    t->capacity = capacity;
+    t->root = BST_ARENA_NIL;
+    return 0;
+}
+
+void BSTArena_destruct(BSTArena *t){
+    free(t->nodes);
+    t->nodes = NULL;
+    t->size = t->capacity = 0;
+    t->root = BST_ARENA_NIL;
+}
+
+static uint32_t bst_arena_node_new(BSTArena *t, int data){
+    if(t->size == t->capacity){
+	if(t->capacity == BST_ARENA_MAX) return BST_ARENA_NIL;
+	uint32_t new_capacity = t->capacity > BST_ARENA_MAX / 2 ? BST_ARENA_MAX : t->capacity << 1u;
+	void *tmp = realloc(t->nodes, (size_t) new_capacity * sizeof(BSTANode));
+	if(!tmp) return BST_ARENA_NIL;
+	t->nodes = tmp;
+	t->capacity = new_capacity;
+    }
+    BSTANode *node = &t->nodes[t->size];
+    node->left = node->right = BST_ARENA_NIL;
+    node->data = data;
+    return t->size++;
+}
+
+/* slot holding data, or NIL with *parent set to where it would hang */
+static uint32_t bst_arena_find(BSTArena *t, int data, uint32_t *parent){
+    uint32_t idx = t->root;
+    *parent = BST_ARENA_NIL;
+    while(idx != BST_ARENA_NIL){
+	BSTANode *node = &t->nodes[idx];
+	if(data == node->data)
+	    return idx;
+	*parent = idx;
+	idx = data > node->data ? child(node->right) : node->left;
+    }
+    return BST_ARENA_NIL;
+}
+
+int BSTArena_insert(BSTArena *t, int data){
+    uint32_t parent;
+    uint32_t idx = bst_arena_find(t, data, &parent);
+
+    if(idx != BST_ARENA_NIL){
+	if(!is_deleted(&t->nodes[idx]))
+	    return ERR_DATA_EXISTS;
+	t->nodes[idx].right &= ~BST_ARENA_DELETED;
+	return 0;
+    }
+
+    /* may move the array, only indices are held across it */
+    idx = bst_arena_node_new(t, data);
+    if(idx == BST_ARENA_NIL) return ERR_MALLOC_FAILED;
+
+    if(parent == BST_ARENA_NIL)
+	t->root = idx;
+    else if(data > t->nodes[parent].data)
+	t->nodes[parent].right |= idx;    /* keeps the parent's tombstone bit */
+    else
+	t->nodes[parent].left = idx;
+    return 0;
+}
+
+int BSTArena_delete(BSTArena *t, int data){
+    uint32_t parent;
+    uint32_t idx = bst_arena_find(t, data, &parent);
+
+    if(idx == BST_ARENA_NIL || is_deleted(&t->nodes[idx]))
+	return ERR_DATA_NOT_FOUND;
+    t->nodes[idx].right |= BST_ARENA_DELETED;
+    return 0;
+}
+
+int BSTArena_search(BSTArena *t, int data){
+    uint32_t parent;
+    uint32_t idx = bst_arena_find(t, data, &parent);
+    return idx != BST_ARENA_NIL && !is_deleted(&t->nodes[idx]) ? 0 : ERR_DATA_NOT_FOUND;
+}
+
+int BSTArena_in_order_visit(BSTArena *t, BSTArena_visit_fn visit, void *arg){
+    SegStack path;
+    uint32_t idx = t->root;
+
+    if(seg_stack_init(&path) < 0) return ERR_MALLOC_FAILED;
+    while(idx != BST_ARENA_NIL || !seg_stack_isempty(&path)){
+	if(idx != BST_ARENA_NIL){
+	    if(seg_stack_push(&path, (void *) (uintptr_t) idx) < 0){
+		seg_stack_destruct(&path);
+		return ERR_MALLOC_FAILED;
+	    }
+	    idx = t->nodes[idx].left;
+	    continue;
+	}
+	void *top;
+	seg_stack_pop(&path, &top);
+	BSTANode *node = &t->nodes[(uintptr_t) top];
+	if(!is_deleted(node))
+	    visit(node->data, arg);
+	idx = child(node->right);
+    }
+    seg_stack_destruct(&path);
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef	    BST_ARENA_H
+#define	    BST_ARENA_H
+
+#include    <stddef.h>
+#include    <stdint.h>
+
+#define	    ERR_MALLOC_FAILED	-1
+#define	    ERR_DATA_EXISTS	-2
+#define	    ERR_DATA_NOT_FOUND	-3
+
+#define	    BST_ARENA_NIL	0u		/* slot 0 is never a node */
+#define	    BST_ARENA_DELETED	0x80000000u	/* top bit of right */
+#define	    BST_ARENA_MAX	0x7fffffffu	/* slots an index can address */
+#define	    BST_ARENA_DFT_CAPACITY	64u
+
+/**
+ * the BST of bst.h with every node in one growable array: children are 32-bit
+ * slot indices and the tombstone is the top bit of right, so a node is 12
+ * bytes instead of 24 and the whole tree goes with a single free. Indices
+ * stay valid when the array moves, pointers into it do not.
+ */
+typedef struct bst_anode {
+    uint32_t left;
+    uint32_t right;	/* child | BST_ARENA_DELETED */
+    int data;
+} BSTANode;
+
+typedef struct bst_arena {
+    BSTANode *nodes;
+    uint32_t size;	/* slots in use, including slot 0 */
+    uint32_t capacity;
+    uint32_t root;
+} BSTArena;
+
+typedef void (*BSTArena_visit_fn)(int data, void *arg);
+
+int BSTArena_init(BSTArena *t, size_t capacity);    /* capacity in nodes, 0 picks the default */
+
+void BSTArena_destruct(BSTArena *t);
+
+int BSTArena_insert(BSTArena *t, int data);         /* inserting over a tombstone revives it */
+
+int BSTArena_delete(BSTArena *t, int data);         /* marks a tombstone, the slot stays used */
+
+int BSTArena_search(BSTArena *t, int data);         /* 0 if data is live */
+
+int BSTArena_in_order_visit(BSTArena *t, BSTArena_visit_fn visit, void *arg);  /* live keys only */
+
+#endif
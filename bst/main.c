@@ -2,8 +2,19 @@
 #include    <stdlib.h> 
 #include    <string.h>
 #include    "bst.h"
+#include    "bst_arena.h"
 #include    "ring_buf.h"
 
+static void print_visit(int data, void *arg){
+    (void) arg;
+    printf("%d\n", data);
+}
+
+static void count_visit(BST *node, void *arg){
+    if(!node->deleted)
+	atomic_fetch_add_explicit((atomic_size_t *) arg, 1, memory_order_relaxed);
+}
+
 int main(){
     BST *root = NULL;
     BST_init(&root);
@@ -47,7 +58,73 @@ int main(){
     printf("postorder traversal:\n");
     BST_post_order_traversal(&root);
 
-    BST_destruct(&root);
+    BSTIter it;
+    BST *node;
+    long sum = 0;
+    BST_iter_init(&it, &root);
+    while((node = BST_iter_next(&it)))
+	sum += node->data;
+    BST_iter_destruct(&it);
+    printf("sum of live keys: %ld\n", sum);
+
+    BST *median = BST_select(&root, root->count / 2);
+    printf("median %d, rank of 40: %zu, keys in [10, 30]: %zu\n",
+	    median->data, BST_rank(&root, 40), BST_count_range(&root, 10, 30));
+
+    TaskPool pool;
+    task_pool_init(&pool, 0);
+
+    atomic_size_t live = 0;
+    BST_post_order_traversal_parallel(&root, &pool, count_visit, &live);
+    printf("live nodes: %zu\n", atomic_load(&live));
+
+    BST_destruct_parallel(&root, &pool);
+    task_pool_destruct(&pool);
+
+    /* ascending inserts make a chain, deleting most of it triggers a rebuild */
+    BSTree tree;
+    BSTree_init(&tree, BST_DFT_DEAD_RATIO);
+    for(int i = 0; i < 1024; ++i)
+	BSTree_insert(&tree, i);
+    for(int i = 0; i < 1024; ++i)
+	if(i % 4)
+	    BSTree_delete(&tree, i);
+    printf("after deletes: %zu live, %zu tombstones, rebuilding: %s\n",
+	    tree.live, tree.dead, tree.rebuild ? "yes" : "no");
+
+    for(int i = 1024; tree.rebuild; ++i)
+	BSTree_insert(&tree, i);
+    printf("after rebuild: %zu live, %zu tombstones, root %d\n", tree.live, tree.dead, tree.root->data);
+    BSTree_destruct(&tree);
+
+    /* ids arrive in order: load them balanced in one block, then merge the next batch */
+    int ids[15], batch[5];
+    for(int i = 0; i < 15; ++i)
+	ids[i] = 100 + 2 * i;
+    for(int i = 0; i < 5; ++i)
+	batch[i] = 101 + 2 * i;
+    BST *loaded = BST_bulk_load(ids, 15);
+    BST_bulk_merge(&loaded, batch, 5);
+    printf("bulk loaded, level traversal:\n");
+    BST_level_traversal(&loaded);
+
+    BSTFrozen frozen = { 0 };
+    BST_freeze(&loaded, &frozen);
+    const int *next_id = BST_frozen_upper_bound(&frozen, 110);
+    printf("frozen: %zu keys, 111 %s, first id after 110: %d\n", frozen.n,
+	    BST_frozen_search(&frozen, 111) == 0 ? "found" : "missing", next_id ? *next_id : -1);
+    BST_frozen_destruct(&frozen);
+    BST_destruct(&loaded);
+
+    /* same keys in the 12-byte index arena, gone with one free */
+    BSTArena arena;
+    BSTArena_init(&arena, 0);
+    for(int i = 0; i < 15; ++i)
+	BSTArena_insert(&arena, ids[i]);
+    BSTArena_delete(&arena, 110);
+    printf("arena: %u slots of %zu bytes, inorder traversal:\n", arena.size - 1, sizeof(BSTANode));
+    BSTArena_in_order_visit(&arena, print_visit, NULL);
+    BSTArena_destruct(&arena);
 
     return 0;
 }
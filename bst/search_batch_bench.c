@@ -0,0 +1,66 @@
+/* bulk membership checks: one dependent walk per key vs BST_search_batch keeping a group in flight */
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <time.h>
+#include    "bst.h"
+
+#define	    NKEYS	(1u << 21)	/* well past the last level cache */
+#define	    NLOOKUPS	(1u << 22)	/* about half of them hit */
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t search_one_by_one(BST **root, const int *keys, size_t n, int *out){
+    size_t found = 0;
+    for(size_t i = 0; i < n; ++i){
+	out[i] = BST_contains(root, keys[i]) ? 0 : ERR_DATA_NOT_FOUND;
+	found += !out[i];
+    }
+    return found;
+}
+
+int main(){
+    int *keys = malloc(NKEYS * sizeof(int));
+    int *lookups = malloc(NLOOKUPS * sizeof(int));
+    int *out = malloc(NLOOKUPS * sizeof(int));
+    unsigned int seed = 1;
+    BST *root = NULL;
+
+    if(!keys || !lookups || !out) return 1;
+
+    /* even keys in random order, so the tree has the usual random shape */
+    for(size_t i = 0; i < NKEYS; ++i)
+	keys[i] = 2 * i;
+    for(size_t i = NKEYS - 1; i > 0; --i){
+	size_t j = rand_r(&seed) % (i + 1);
+	int tmp = keys[i];
+	keys[i] = keys[j];
+	keys[j] = tmp;
+    }
+    for(size_t i = 0; i < NKEYS; ++i)
+	BST_insert(&root, keys[i]);
+    for(size_t i = 0; i < NLOOKUPS; ++i)
+	lookups[i] = rand_r(&seed) % (2 * NKEYS);
+
+    double start = now_sec();
+    size_t plain = search_one_by_one(&root, lookups, NLOOKUPS, out);
+    double t_plain = now_sec() - start;
+
+    start = now_sec();
+    size_t batch = BST_search_batch(&root, lookups, NLOOKUPS, out);
+    double t_batch = now_sec() - start;
+
+    printf("%u keys, %u lookups, group of %u\n", NKEYS, NLOOKUPS, BST_BATCH_GROUP);
+    printf("one by one: %6.1f ns/lookup (%zu found)\n", t_plain / NLOOKUPS * 1e9, plain);
+    printf("batched:    %6.1f ns/lookup (%zu found)\n", t_batch / NLOOKUPS * 1e9, batch);
+
+    BST_destruct(&root);
+    free(keys);
+    free(lookups);
+    free(out);
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    "splay.h"
+#include    "../stack/seg_stack.h"
+
+/**
+ * bring data, or the last node before falling off the tree, to the root.
+ * header.right_node gathers the left tree and header.left_node the right
+ * tree; left/right point at the node where the next piece hangs.
+ */
+static Splay *splay(Splay *node, int data){
+    Splay header = { NULL, NULL, 0 };
+    Splay *left = &header, *right = &header;
+
+    if(!node) return NULL;
+    for(;;){
+	if(data < node->data){
+	    if(!node->left_node) break;
+	    if(data < node->left_node->data){
+		/* zig-zig: rotate right first */
+		Splay *child = node->left_node;
+		node->left_node = child->right_node;
+		child->right_node = node;
+		node = child;
+		if(!node->left_node) break;
+	    }
+	    /* link right */
+	    right->left_node = node;
+	    right = node;
+	    node = node->left_node;
+	} else if(data > node->data){
+	    if(!node->right_node) break;
+	    if(data > node->right_node->data){
+		/* zag-zag: rotate left first */
+		Splay *child = node->right_node;
+		node->right_node = child->left_node;
+		child->left_node = node;
+		node = child;
+		if(!node->right_node) break;
+	    }
+	    /* link left */
+	    left->right_node = node;
+	    left = node;
+	    node = node->right_node;
+	} else
+	    break;
+    }
+
+    /* assemble */
+    left->right_node = node->left_node;
+    right->left_node = node->right_node;
+    node->left_node = header.right_node;
+    node->right_node = header.left_node;
+    return node;
+}
+
+int Splay_insert(Splay **root, int data){
+    Splay *node = *root = splay(*root, data);
+    if(node && node->data == data)
+	return ERR_DATA_EXISTS;
+
+    Splay *new_node = malloc(sizeof(Splay));
+    if(!new_node) return ERR_MALLOC_FAILED;
+    new_node->data = data;
+
+    /* the old root is data's neighbour, split the tree around it */
+    if(!node){
+	new_node->left_node = new_node->right_node = NULL;
+    } else if(data < node->data){
+	new_node->left_node = node->left_node;
+	new_node->right_node = node;
+	node->left_node = NULL;
+    } else {
+	new_node->right_node = node->right_node;
+	new_node->left_node = node;
+	node->right_node = NULL;
+    }
+    *root = new_node;
+    return 0;
+}
+
+int Splay_delete(Splay **root, int data){
+    Splay *node = *root = splay(*root, data);
+    if(!node || node->data != data)
+	return ERR_DATA_NOT_FOUND;
+
+    /* every key on the left is smaller, so splaying data there lifts its maximum */
+    if(!node->left_node){
+	*root = node->right_node;
+    } else {
+	*root = splay(node->left_node, data);
+	(*root)->right_node = node->right_node;
+    }
+    free(node);
+    return 0;
+}
+
+int Splay_search(Splay **root, int data){
+    *root = splay(*root, data);
+    return *root && (*root)->data == data ? 0 : ERR_DATA_NOT_FOUND;
+}
+
+/* rotate left children up until the top has none, then free it: no stack at all */
+void Splay_destruct(Splay **root){
+    Splay *node = *root;
+
+    while(node){
+	if(node->left_node){
+	    Splay *left = node->left_node;
+	    node->left_node = left->right_node;
+	    left->right_node = node;
+	    node = left;
+	} else {
+	    Splay *right = node->right_node;
+	    free(node);
+	    node = right;
+	}
+    }
+    *root = NULL;
+}
+
+void Splay_in_order_traversal(Splay **root){
+    SegStack path;
+    Splay *node = *root;
+
+    if(seg_stack_init(&path) < 0) return;
+    while(node || !seg_stack_isempty(&path)){
+	if(node){
+	    if(seg_stack_push(&path, node) < 0) break;
+	    node = node->left_node;
+	    continue;
+	}
+	void *top;
+	seg_stack_pop(&path, &top);
+	node = top;
+	printf("%d\n", node->data);
+	node = node->right_node;
+    }
+    seg_stack_destruct(&path);
+}
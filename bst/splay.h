@@ -0,0 +1,34 @@
+#ifndef	    SPLAY_H
+#define	    SPLAY_H
+
+#define	    ERR_MALLOC_FAILED	-1
+#define	    ERR_DATA_EXISTS	-2
+#define	    ERR_DATA_NOT_FOUND	-3
+
+/**
+ * self-adjusting BST with the calls of bst.h. Every access splays the key (or
+ * the last node on its path) to the root top-down in one pass (Sleator and
+ * Tarjan): nodes left of the path collect in a left tree, nodes right of it in
+ * a right tree, and zig-zig steps rotate first so the path roughly halves.
+ * Hot keys therefore stay near the root, and any sequence of m operations
+ * costs O(m log n). Delete really unlinks, nothing is left behind.
+ * Search changes the tree too, so even readers need exclusive access.
+ */
+typedef struct splay Splay;
+struct splay {
+    Splay *left_node;
+    Splay *right_node;
+    int data;
+};
+
+int Splay_insert(Splay **root, int data);
+
+int Splay_delete(Splay **root, int data);
+
+int Splay_search(Splay **root, int data);   /* 0 if found, which leaves data at the root */
+
+void Splay_destruct(Splay **root);
+
+void Splay_in_order_traversal(Splay **root);
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * lookups on Zipf-distributed traces: splay tree vs the plain BST and the AVL tree.
+ * pow() needs libm, build with -lm:
+ * gcc -std=gnu11 -O2 splay_bench.c splay.c bst.c ring_buf.c ../advanced_trees/avl.c \
+ *     ../stack/seg_stack.c ../concurrent/task_pool.c ../concurrent/ws_deque.c -pthread -lm
+ */
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <math.h>
+#include    <time.h>
+#include    "bst.h"
+#include    "splay.h"
+#include    "../advanced_trees/avl.h"
+
+#define	    NKEYS	(1u << 20)
+#define	    NLOOKUPS	(1u << 22)
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * rank r (from 0) is drawn with probability ~ 1 / (r + 1)^s through the CDF,
+ * then mapped to keys[r]; keys are shuffled, so hot keys are spread over the
+ * key space rather than clustered at one end of the tree. s = 0 is uniform.
+ */
+static void zipf_trace(int *trace, const int *keys, double s, unsigned int *seed){
+    double *cdf = malloc(NKEYS * sizeof(double));
+    double sum = 0;
+
+    for(size_t r = 0; r < NKEYS; ++r){
+	sum += 1.0 / pow(r + 1, s);
+	cdf[r] = sum;
+    }
+    for(size_t i = 0; i < NLOOKUPS; ++i){
+	double u = (double) rand_r(seed) / RAND_MAX * sum;
+	size_t lo = 0, hi = NKEYS - 1;
+	while(lo < hi){
+	    size_t mid = lo + (hi - lo) / 2;
+	    if(cdf[mid] < u)
+		lo = mid + 1;
+	    else
+		hi = mid;
+	}
+	trace[i] = keys[lo];
+    }
+    free(cdf);
+}
+
+int main(){
+    static const double skews[] = { 0, 0.8, 0.99, 1.2 };
+    int *keys = malloc(NKEYS * sizeof(int));
+    int *trace = malloc(NLOOKUPS * sizeof(int));
+    unsigned int seed = 1;
+    BST *bst = NULL;
+    Splay *splay = NULL;
+    AVL avl;
+
+    if(!keys || !trace) return 1;
+    for(size_t i = 0; i < NKEYS; ++i)
+	keys[i] = i;
+    for(size_t i = NKEYS - 1; i > 0; --i){
+	size_t j = rand_r(&seed) % (i + 1);
+	int tmp = keys[i];
+	keys[i] = keys[j];
+	keys[j] = tmp;
+    }
+
+    /* all three see the same random insertion order */
+    avl_init(&avl);
+    for(size_t i = 0; i < NKEYS; ++i){
+	BST_insert(&bst, keys[i]);
+	Splay_insert(&splay, keys[i]);
+	avl_insert(&avl, keys[i]);
+    }
+
+    printf("%u keys, %u lookups, ns per lookup\n", NKEYS, NLOOKUPS);
+    printf("%6s %10s %10s %10s\n", "zipf s", "BST", "AVL", "splay");
+    for(size_t k = 0; k < sizeof(skews) / sizeof(skews[0]); ++k){
+	size_t hits = 0;
+	double start, t_bst, t_avl, t_splay;
+
+	zipf_trace(trace, keys, skews[k], &seed);
+
+	start = now_sec();
+	for(size_t i = 0; i < NLOOKUPS; ++i)
+	    hits += BST_contains(&bst, trace[i]);
+	t_bst = now_sec() - start;
+
+	start = now_sec();
+	for(size_t i = 0; i < NLOOKUPS; ++i)
+	    hits += avl_search(&avl, trace[i]) != NULL;
+	t_avl = now_sec() - start;
+
+	start = now_sec();
+	for(size_t i = 0; i < NLOOKUPS; ++i)
+	    hits += Splay_search(&splay, trace[i]) == 0;
+	t_splay = now_sec() - start;
+
+	if(hits != 3 * (size_t) NLOOKUPS)
+	    printf("lost lookups: %zu\n", 3 * (size_t) NLOOKUPS - hits);
+	printf("%6.2f %10.1f %10.1f %10.1f\n", skews[k],
+		t_bst / NLOOKUPS * 1e9, t_avl / NLOOKUPS * 1e9, t_splay / NLOOKUPS * 1e9);
+    }
+
+    BST_destruct(&bst);
+    Splay_destruct(&splay);
+    avl_destroy(&avl);
+    free(keys);
+    free(trace);
+    return 0;
+}
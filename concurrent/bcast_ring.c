@@ -0,0 +1,87 @@
+#include    <stdlib.h>
+#include    <string.h>
+#include    <sched.h>
+#include    "bcast_ring.h"
+
+static inline void *bcast_slot(BcastRing *ring, size_t seq){
+    return ring->slots + (seq & (ring->capacity - 1)) * ring->elem_size;
+}
+
+static size_t bcast_min_seq(BcastRing *ring){
+    size_t min = atomic_load_explicit(&ring->cursor, memory_order_relaxed);
+    for(size_t i = 0; i < ring->nreaders; ++i){
+	size_t seq = atomic_load_explicit(&ring->readers[i].seq, memory_order_acquire);
+	if(seq < min)
+	    min = seq;
+    }
+    return min;
+}
+
+int bcast_init(BcastRing *ring, size_t capacity, size_t elem_size, size_t nreaders){
+    if(capacity == 0 || (capacity & (capacity - 1)) || nreaders == 0) return -1;
+
+    ring->readers = aligned_alloc(alignof(BcastReader), sizeof(BcastReader) * nreaders);
+    if(!ring->readers) return -1;
+    ring->slots = malloc(capacity * elem_size);
+    if(!ring->slots){
+	free(ring->readers);
+	return -1;
+    }
+
+    for(size_t i = 0; i < nreaders; ++i)
+	atomic_init(&ring->readers[i].seq, 0);
+    atomic_init(&ring->cursor, 0);
+    ring->min_seq = 0;
+    ring->capacity = capacity;
+    ring->elem_size = elem_size;
+    ring->nreaders = nreaders;
+    return 0;
+}
+
+int bcast_destruct(BcastRing *ring){
+    free(ring->readers);
+    free(ring->slots);
+    return 0;
+}
+
+void *bcast_claim(BcastRing *ring){
+    size_t cursor = atomic_load_explicit(&ring->cursor, memory_order_relaxed);
+
+    /* only rescan the readers when the cached minimum says we are full */
+    if(cursor - ring->min_seq >= ring->capacity){
+	ring->min_seq = bcast_min_seq(ring);
+	if(cursor - ring->min_seq >= ring->capacity)
+	    return NULL;
+    }
+    return bcast_slot(ring, cursor);
+}
+
+void bcast_publish(BcastRing *ring){
+    size_t cursor = atomic_load_explicit(&ring->cursor, memory_order_relaxed);
+    atomic_store_explicit(&ring->cursor, cursor + 1, memory_order_release);
+}
+
+int bcast_push(BcastRing *ring, const void *elem){
+    void *slot;
+    while(!(slot = bcast_claim(ring)))
+	sched_yield();
+    memcpy(slot, elem, ring->elem_size);
+    bcast_publish(ring);
+    return 0;
+}
+
+size_t bcast_poll(BcastRing *ring, size_t reader){
+    size_t seq = atomic_load_explicit(&ring->readers[reader].seq, memory_order_relaxed);
+    return atomic_load_explicit(&ring->cursor, memory_order_acquire) - seq;
+}
+
+void *bcast_at(BcastRing *ring, size_t reader, size_t i){
+    size_t seq = atomic_load_explicit(&ring->readers[reader].seq, memory_order_relaxed);
+    return bcast_slot(ring, seq + i);
+}
+
+void bcast_consume(BcastRing *ring, size_t reader, size_t n){
+    size_t seq = atomic_load_explicit(&ring->readers[reader].seq, memory_order_relaxed);
+    /* release: we are done reading those slots, the writer may overwrite them */
+    atomic_store_explicit(&ring->readers[reader].seq, seq + n, memory_order_release);
+}
@@ -0,0 +1,46 @@
+#ifndef	    BCAST_RING_H
+#define	    BCAST_RING_H
+
+#include    <stddef.h>
+#include    <stdalign.h>
+#include    <stdatomic.h>
+
+/**
+ * Single-writer multi-reader broadcast ring (Disruptor style).
+ * Every reader sees every element: it keeps its own sequence and reads the
+ * slots in place, nothing is copied per reader and nothing is locked.
+ * The writer may only reuse a slot once the slowest reader has passed it.
+ */
+typedef struct bcast_reader {
+    alignas(64) _Atomic size_t seq;     /* next sequence this reader will read */
+} BcastReader;
+
+typedef struct bcast_ring {
+    alignas(64) _Atomic size_t cursor;  /* next sequence the writer will publish */
+    alignas(64) size_t min_seq;         /* writer's cached view of the slowest reader */
+    size_t capacity;                    /* power of 2 */
+    size_t elem_size;
+    size_t nreaders;
+    BcastReader *readers;
+    char *slots;
+} BcastRing;
+
+int bcast_init(BcastRing *ring, size_t capacity, size_t elem_size, size_t nreaders);
+
+int bcast_destruct(BcastRing *ring);
+
+/* writer */
+void *bcast_claim(BcastRing *ring);                 /* next slot to fill, NULL if the slowest reader is a lap behind */
+
+void bcast_publish(BcastRing *ring);                /* make the claimed slot visible */
+
+int bcast_push(BcastRing *ring, const void *elem);  /* claim, copy in, publish, yields while full */
+
+/* reader */
+size_t bcast_poll(BcastRing *ring, size_t reader);  /* number of published elements not read yet */
+
+void *bcast_at(BcastRing *ring, size_t reader, size_t i);   /* i-th unread element, in place */
+
+void bcast_consume(BcastRing *ring, size_t reader, size_t n);
+
+#endif
@@ -0,0 +1,118 @@
+/* broadcast ring: one writer, every reader sees every message; back-pressure from a slow reader */
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <pthread.h>
+#include    <sched.h>
+#include    <time.h>
+#include    "bcast_ring.h"
+
+#define	    NMSGS		2000000u
+#define	    MAX_READERS		8u
+#define	    RING_CAPACITY	1024u
+#define	    SLOW_SPIN		200u	/* busy loop per message for the slow reader */
+
+typedef struct msg {
+    uint64_t seq;
+    uint64_t payload;
+} Msg;
+
+typedef struct reader_arg {
+    pthread_barrier_t *barrier;
+    size_t id;
+    unsigned int spin;
+    size_t bad;		/* messages missing, out of order or torn */
+} ReaderArg;
+
+static BcastRing ring;
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* read whole batches in place, check each message is the next one, then hand the slots back */
+static void *reader(void *arg){
+    ReaderArg *a = arg;
+    uint64_t expect = 0;
+    pthread_barrier_wait(a->barrier);
+
+    while(expect < NMSGS){
+	size_t n = bcast_poll(&ring, a->id);
+	if(!n){
+	    sched_yield();
+	    continue;
+	}
+	for(size_t i = 0; i < n; ++i){
+	    Msg *m = bcast_at(&ring, a->id, i);
+	    a->bad += m->seq != expect || m->payload != expect * 2654435761u;
+	    ++expect;
+	    for(volatile unsigned int s = 0; s < a->spin; ++s)
+		;
+	}
+	bcast_consume(&ring, a->id, n);
+    }
+    return NULL;
+}
+
+/* fill the claimed slot in place; a NULL claim means the slowest reader is a lap behind */
+static size_t writer(void){
+    size_t stalls = 0;
+    for(uint64_t seq = 0; seq < NMSGS; ++seq){
+	Msg *m;
+	while(!(m = bcast_claim(&ring))){
+	    ++stalls;
+	    sched_yield();
+	}
+	m->seq = seq;
+	m->payload = seq * 2654435761u;
+	bcast_publish(&ring);
+    }
+    return stalls;
+}
+
+static double run(size_t nreaders, int slow, size_t *stalls, size_t *bad){
+    pthread_t tids[MAX_READERS];
+    ReaderArg args[MAX_READERS];
+    pthread_barrier_t barrier;
+    double start, elapsed;
+
+    if(bcast_init(&ring, RING_CAPACITY, sizeof(Msg), nreaders) < 0){
+	perror("bcast_init");
+	exit(1);
+    }
+    pthread_barrier_init(&barrier, NULL, nreaders + 1);
+    for(size_t i = 0; i < nreaders; ++i){
+	args[i] = (ReaderArg){ .barrier = &barrier, .id = i, .spin = slow && i == 0 ? SLOW_SPIN : 0, .bad = 0 };
+	pthread_create(&tids[i], NULL, reader, &args[i]);
+    }
+
+    pthread_barrier_wait(&barrier);
+    start = now_sec();
+    *stalls = writer();
+    for(size_t i = 0; i < nreaders; ++i)
+	pthread_join(tids[i], NULL);
+    elapsed = now_sec() - start;
+
+    *bad = 0;
+    for(size_t i = 0; i < nreaders; ++i)
+	*bad += args[i].bad;
+    pthread_barrier_destroy(&barrier);
+    bcast_destruct(&ring);
+    return NMSGS / elapsed;
+}
+
+int main(){
+    printf("%u messages, ring of %u\n", NMSGS, RING_CAPACITY);
+    printf("%8s %12s %16s %14s %8s\n", "readers", "slow reader", "messages/s", "writer stalls", "errors");
+    for(int slow = 0; slow <= 1; ++slow){
+	for(size_t n = 1; n <= MAX_READERS; n <<= 1u){
+	    size_t stalls, bad;
+	    double rate = run(n, slow, &stalls, &bad);
+	    printf("%8zu %12s %16.0f %14zu %8zu\n", n, slow ? "yes" : "no", rate, stalls, bad);
+	}
+    }
+    return 0;
+}
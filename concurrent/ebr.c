@@ -0,0 +1,134 @@
+#include    <stdlib.h>
+#include    "ebr.h"
+
+#define	    EBR_ACTIVE		1ul
+#define	    EBR_LIMBO_DFT_CAPACITY	EBR_BATCH
+
+static void limbo_free(EbrLimbo *limbo){
+    for(size_t i = 0; i < limbo->size; ++i)
+	limbo->items[i].free_fn(limbo->items[i].ptr);
+    limbo->size = 0;
+}
+
+/* free every bucket at least two epochs behind the global one */
+static void ebr_reclaim(EbrThread *t, unsigned long global){
+    for(size_t i = 0; i < EBR_EPOCHS; ++i){
+	EbrLimbo *limbo = &t->limbo[i];
+	if(limbo->size && limbo->epoch + 2 <= global)
+	    limbo_free(limbo);
+    }
+}
+
+/* the epoch moves on only when every thread inside a critical section has seen it */
+static unsigned long ebr_try_advance(Ebr *ebr){
+    unsigned long global = atomic_load_explicit(&ebr->epoch, memory_order_seq_cst);
+
+    for(EbrThread *p = atomic_load_explicit(&ebr->threads, memory_order_acquire); p; p = p->next){
+	unsigned long local = atomic_load_explicit(&p->local, memory_order_seq_cst);
+	if((local & EBR_ACTIVE) && (local >> 1) != global)
+	    return global;
+    }
+
+    if(atomic_compare_exchange_strong_explicit(&ebr->epoch, &global, global + 1,
+		memory_order_seq_cst, memory_order_seq_cst))
+	return global + 1;
+    return global; /* someone else advanced it, global holds the new value */
+}
+
+int ebr_init(Ebr *ebr){
+    atomic_init(&ebr->epoch, 0);
+    atomic_init(&ebr->threads, NULL);
+    return 0;
+}
+
+int ebr_destruct(Ebr *ebr){
+    EbrThread *p = atomic_load_explicit(&ebr->threads, memory_order_acquire);
+    while(p){
+	EbrThread *next = p->next;
+	for(size_t i = 0; i < EBR_EPOCHS; ++i){
+	    limbo_free(&p->limbo[i]);
+	    free(p->limbo[i].items);
+	}
+	free(p);
+	p = next;
+    }
+    atomic_store_explicit(&ebr->threads, NULL, memory_order_relaxed);
+    return 0;
+}
+
+EbrThread *ebr_register(Ebr *ebr){
+    /* reuse a record left by an exited thread */
+    for(EbrThread *p = atomic_load_explicit(&ebr->threads, memory_order_acquire); p; p = p->next){
+	bool expected = false;
+	if(atomic_compare_exchange_strong_explicit(&p->in_use, &expected, true,
+		    memory_order_acquire, memory_order_relaxed))
+	    return p;
+    }
+
+    EbrThread *t = calloc(1, sizeof(EbrThread));
+    if(!t) return NULL;
+    t->ebr = ebr;
+    atomic_init(&t->local, 0);
+    atomic_init(&t->in_use, true);
+
+    EbrThread *head = atomic_load_explicit(&ebr->threads, memory_order_relaxed);
+    do {
+	t->next = head;
+    } while(!atomic_compare_exchange_weak_explicit(&ebr->threads, &head, t,
+		memory_order_release, memory_order_relaxed));
+
+    return t;
+}
+
+void ebr_unregister(EbrThread *t){
+    ebr_flush(t);
+    t->nest = 0;
+    atomic_store_explicit(&t->local, 0, memory_order_release);
+    atomic_store_explicit(&t->in_use, false, memory_order_release);
+}
+
+void ebr_enter(EbrThread *t){
+    if(t->nest++)
+	return;
+    unsigned long global = atomic_load_explicit(&t->ebr->epoch, memory_order_relaxed);
+    /* seq_cst: the announcement must be visible before any shared load that follows */
+    atomic_store_explicit(&t->local, (global << 1) | EBR_ACTIVE, memory_order_seq_cst);
+}
+
+void ebr_exit(EbrThread *t){
+    if(--t->nest)
+	return;
+    atomic_store_explicit(&t->local, 0, memory_order_release);
+}
+
+int ebr_retire(EbrThread *t, void *ptr, ebr_free_fn free_fn){
+    unsigned long global = atomic_load_explicit(&t->ebr->epoch, memory_order_acquire);
+    EbrLimbo *limbo = &t->limbo[global % EBR_EPOCHS];
+
+    /* the bucket still holds epoch global - 3 or older, which is safe by now */
+    if(limbo->epoch != global){
+	limbo_free(limbo);
+	limbo->epoch = global;
+    }
+
+    if(limbo->size == limbo->capacity){
+	size_t new_capacity = limbo->capacity ? limbo->capacity << 1u : EBR_LIMBO_DFT_CAPACITY;
+	void *tmp = realloc(limbo->items, sizeof(EbrRetired) * new_capacity);
+	if(!tmp) return -1;
+	// invariant: tmp is malloc successfully
+	limbo->items = tmp;
+	limbo->capacity = new_capacity;
+    }
+    limbo->items[limbo->size++] = (EbrRetired){ .ptr = ptr, .free_fn = free_fn };
+
+    if(++t->retired >= EBR_BATCH){
+	t->retired = 0;
+	ebr_reclaim(t, ebr_try_advance(t->ebr));
+    }
+    return 0;
+}
+
+void ebr_flush(EbrThread *t){
+    t->retired = 0;
+    ebr_reclaim(t, ebr_try_advance(t->ebr));
+}
@@ -0,0 +1,66 @@
+#ifndef	    EBR_H
+#define	    EBR_H
+
+#include    <stddef.h>
+#include    <stdbool.h>
+#include    <stdalign.h>
+#include    <stdatomic.h>
+
+#define	    EBR_EPOCHS		3u	/* current, previous and the one being freed */
+#define	    EBR_BATCH		64u	/* retires between attempts to advance the epoch */
+
+/**
+ * Epoch-based reclamation (Fraser). Readers wrap every access to shared nodes in
+ * ebr_enter/ebr_exit, writers unlink a node and hand it to ebr_retire instead of
+ * free. A node retired in epoch e is freed once the global epoch reaches e + 2,
+ * i.e. when every thread has left the critical sections that might still see it.
+ * Each thread gets its own record from ebr_register and passes it to every call.
+ */
+typedef void (*ebr_free_fn)(void *ptr);
+
+typedef struct ebr_retired {
+    void *ptr;
+    ebr_free_fn free_fn;
+} EbrRetired;
+
+typedef struct ebr_limbo {
+    EbrRetired *items;
+    size_t size;
+    size_t capacity;
+    unsigned long epoch;      /* epoch the items were retired in */
+} EbrLimbo;
+
+typedef struct ebr Ebr;
+
+typedef struct ebr_thread {
+    alignas(64) _Atomic unsigned long local;   /* epoch << 1 | 1 while inside, 0 outside */
+    struct ebr_thread *next;                   /* registry, records are never unlinked */
+    Ebr *ebr;
+    atomic_bool in_use;
+    unsigned int nest;
+    size_t retired;                            /* since the last advance attempt */
+    EbrLimbo limbo[EBR_EPOCHS];
+} EbrThread;
+
+struct ebr {
+    alignas(64) _Atomic unsigned long epoch;
+    _Atomic(EbrThread *) threads;
+};
+
+int ebr_init(Ebr *ebr);
+
+int ebr_destruct(Ebr *ebr);              /* no thread may be registered any more */
+
+EbrThread *ebr_register(Ebr *ebr);
+
+void ebr_unregister(EbrThread *t);       /* pending nodes stay with the record for the next owner */
+
+void ebr_enter(EbrThread *t);
+
+void ebr_exit(EbrThread *t);
+
+int ebr_retire(EbrThread *t, void *ptr, ebr_free_fn free_fn);
+
+void ebr_flush(EbrThread *t);            /* try to advance and free what is safe now */
+
+#endif
@@ -0,0 +1,200 @@
+/* reclamation overhead: epoch-based vs hazard pointers on a lock-free stack of malloc'd nodes */
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <pthread.h>
+#include    <sched.h>
+#include    <time.h>
+#include    "ebr.h"
+
+#define	    OPS_PER_THREAD	500000u
+#define	    MAX_THREADS		16u
+#define	    PREFILL		1024u
+#define	    HP_SCAN_THRESHOLD	(2u * MAX_THREADS)
+
+typedef struct lf_node {
+    struct lf_node *next;
+    long val;
+} LfNode;
+
+typedef struct hazard {
+    alignas(64) _Atomic(LfNode *) ptr;
+} Hazard;
+
+typedef struct hp_thread {
+    size_t id;
+    LfNode *retired[HP_SCAN_THRESHOLD];
+    size_t nretired;
+} HpThread;
+
+typedef struct bench_arg {
+    pthread_barrier_t *barrier;
+    size_t id;
+} BenchArg;
+
+static _Atomic(LfNode *) top;
+static Ebr ebr;
+static Hazard hazards[MAX_THREADS];
+
+static void lf_push(long val){
+    LfNode *node = malloc(sizeof(LfNode));
+    if(!node) return;
+    node->val = val;
+    node->next = atomic_load_explicit(&top, memory_order_relaxed);
+    while(!atomic_compare_exchange_weak_explicit(&top, &node->next, node,
+		memory_order_release, memory_order_relaxed))
+	;
+}
+
+static LfNode *lf_pop_ebr(EbrThread *t){
+    LfNode *node;
+
+    ebr_enter(t);
+    node = atomic_load_explicit(&top, memory_order_acquire);
+    while(node && !atomic_compare_exchange_weak_explicit(&top, &node, node->next,
+		memory_order_acquire, memory_order_acquire))
+	;
+    ebr_exit(t);
+    return node;
+}
+
+static LfNode *lf_pop_hp(HpThread *t){
+    _Atomic(LfNode *) *hp = &hazards[t->id].ptr;
+    LfNode *node;
+
+    for(;;){
+	node = atomic_load_explicit(&top, memory_order_acquire);
+	if(!node) break;
+	/* publish, then make sure it is still reachable */
+	atomic_store_explicit(hp, node, memory_order_seq_cst);
+	if(atomic_load_explicit(&top, memory_order_seq_cst) != node)
+	    continue;
+	if(atomic_compare_exchange_strong_explicit(&top, &node, node->next,
+		    memory_order_acquire, memory_order_relaxed))
+	    break;
+    }
+    atomic_store_explicit(hp, NULL, memory_order_release);
+    return node;
+}
+
+static void hp_scan(HpThread *t){
+    LfNode *protected[MAX_THREADS];
+    size_t kept = 0;
+
+    for(size_t i = 0; i < MAX_THREADS; ++i)
+	protected[i] = atomic_load_explicit(&hazards[i].ptr, memory_order_seq_cst);
+
+    for(size_t i = 0; i < t->nretired; ++i){
+	LfNode *node = t->retired[i];
+	_Bool busy = 0;
+	for(size_t j = 0; j < MAX_THREADS && !busy; ++j)
+	    busy = (protected[j] == node);
+	if(busy)
+	    t->retired[kept++] = node;
+	else
+	    free(node);
+    }
+    t->nretired = kept;
+}
+
+static void hp_retire(HpThread *t, LfNode *node){
+    t->retired[t->nretired++] = node;
+    if(t->nretired == HP_SCAN_THRESHOLD)
+	hp_scan(t);
+}
+
+static void *ebr_worker(void *arg){
+    BenchArg *a = arg;
+    EbrThread *t = ebr_register(&ebr);
+    pthread_barrier_wait(a->barrier);
+
+    for(size_t i = 0; i < OPS_PER_THREAD; ++i){
+	LfNode *node = lf_pop_ebr(t);
+	if(node){
+	    lf_push(node->val + 1);
+	    ebr_retire(t, node, free);
+	}
+    }
+    ebr_unregister(t);
+    return NULL;
+}
+
+static void *hp_worker(void *arg){
+    BenchArg *a = arg;
+    HpThread t = { .id = a->id, .nretired = 0 };
+    pthread_barrier_wait(a->barrier);
+
+    for(size_t i = 0; i < OPS_PER_THREAD; ++i){
+	LfNode *node = lf_pop_hp(&t);
+	if(node){
+	    lf_push(node->val + 1);
+	    hp_retire(&t, node);
+	}
+    }
+    /* a slow thread may still hold a hazard on one of ours, rescan until it lets go */
+    while(t.nretired){
+	hp_scan(&t);
+	if(t.nretired)
+	    sched_yield();
+    }
+    return NULL;
+}
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void stack_fill(void){
+    for(size_t i = 0; i < PREFILL; ++i)
+	lf_push(0);
+}
+
+static void stack_drain(void){
+    LfNode *node = atomic_load(&top);
+    while(node){
+	LfNode *next = node->next;
+	free(node);
+	node = next;
+    }
+    atomic_store(&top, NULL);
+}
+
+static double run(void *(*worker)(void *), size_t nthreads){
+    pthread_t tids[MAX_THREADS];
+    BenchArg args[MAX_THREADS];
+    pthread_barrier_t barrier;
+    double start, elapsed;
+
+    stack_fill();
+    pthread_barrier_init(&barrier, NULL, nthreads + 1);
+    for(size_t i = 0; i < nthreads; ++i){
+	args[i] = (BenchArg){ .barrier = &barrier, .id = i };
+	pthread_create(&tids[i], NULL, worker, &args[i]);
+    }
+
+    start = now_sec();
+    pthread_barrier_wait(&barrier);
+    for(size_t i = 0; i < nthreads; ++i)
+	pthread_join(tids[i], NULL);
+    elapsed = now_sec() - start;
+
+    pthread_barrier_destroy(&barrier);
+    stack_drain();
+    return (double) OPS_PER_THREAD * nthreads / elapsed;
+}
+
+int main(){
+    ebr_init(&ebr);
+
+    printf("%8s %16s %16s\n", "threads", "ebr ops/s", "hazard ops/s");
+    for(size_t n = 1; n <= MAX_THREADS; n <<= 1u){
+	double e = run(ebr_worker, n);
+	double h = run(hp_worker, n);
+	printf("%8zu %16.0f %16.0f\n", n, e, h);
+    }
+
+    ebr_destruct(&ebr);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include    <stdlib.h>
+#include    <sched.h>
+#include    "flat_combining.h"
+
+static void fc_combine(Fc *fc){
+    for(unsigned int pass = 0; pass < FC_COMBINE_PASSES; ++pass){
+	bool served = false;
+	for(FcSlot *s = atomic_load_explicit(&fc->slots, memory_order_acquire); s; s = s->next){
+	    if(!atomic_load_explicit(&s->pending, memory_order_acquire))
+		continue;
+	    s->ret = fc->apply(fc->obj, s->op, s->arg);
+	    atomic_store_explicit(&s->pending, 0, memory_order_release);
+	    served = true;
+	}
+	if(!served)
+	    break;
+    }
+}
+
+int fc_init(Fc *fc, void *obj, fc_apply_fn apply){
+    atomic_init(&fc->locked, false);
+    atomic_init(&fc->slots, NULL);
+    fc->obj = obj;
+    fc->apply = apply;
+    return 0;
+}
+
+int fc_destruct(Fc *fc){
+    FcSlot *s = atomic_load_explicit(&fc->slots, memory_order_acquire);
+    while(s){
+	FcSlot *next = s->next;
+	free(s);
+	s = next;
+    }
+    atomic_store_explicit(&fc->slots, NULL, memory_order_relaxed);
+    return 0;
+}
+
+FcSlot *fc_register(Fc *fc){
+    /* reuse a slot left by an exited thread */
+    for(FcSlot *s = atomic_load_explicit(&fc->slots, memory_order_acquire); s; s = s->next){
+	bool expected = false;
+	if(atomic_compare_exchange_strong_explicit(&s->in_use, &expected, true,
+		    memory_order_acquire, memory_order_relaxed))
+	    return s;
+    }
+
+    FcSlot *slot = aligned_alloc(alignof(FcSlot), sizeof(FcSlot));
+    if(!slot) return NULL;
+    atomic_init(&slot->pending, 0);
+    atomic_init(&slot->in_use, true);
+
+    FcSlot *head = atomic_load_explicit(&fc->slots, memory_order_relaxed);
+    do {
+	slot->next = head;
+    } while(!atomic_compare_exchange_weak_explicit(&fc->slots, &head, slot,
+		memory_order_release, memory_order_relaxed));
+
+    return slot;
+}
+
+void fc_unregister(FcSlot *slot){
+    atomic_store_explicit(&slot->in_use, false, memory_order_release);
+}
+
+long fc_execute(Fc *fc, FcSlot *slot, int op, long arg){
+    slot->op = op;
+    slot->arg = arg;
+    atomic_store_explicit(&slot->pending, 1, memory_order_release);
+
+    for(;;){
+	if(!atomic_load_explicit(&fc->locked, memory_order_relaxed) &&
+		!atomic_exchange_explicit(&fc->locked, true, memory_order_acquire)){
+	    fc_combine(fc);
+	    atomic_store_explicit(&fc->locked, false, memory_order_release);
+	    // invariant: our slot was published before we took the lock, so it is served
+	    return slot->ret;
+	}
+
+	/* someone else is combining, wait for our answer or for the lock to drop */
+	for(unsigned int spins = 0; atomic_load_explicit(&slot->pending, memory_order_acquire); ++spins){
+	    if(!atomic_load_explicit(&fc->locked, memory_order_relaxed))
+		break;
+	    if(spins >= FC_SPINS)
+		sched_yield();
+	}
+	if(!atomic_load_explicit(&slot->pending, memory_order_acquire))
+	    return slot->ret;
+    }
+}
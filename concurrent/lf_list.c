@@ -0,0 +1,127 @@
+#include    <stdlib.h>
+#include    "lf_list.h"
+
+#define	    MARK		1u
+#define	    is_marked(p)	((p) & MARK)
+#define	    get_node(p)		((LfNode *) ((p) & ~(uintptr_t) MARK))
+
+/**
+ * position prev/curr so that *prev == curr and curr is the first node with
+ * key >= key, unlinking every marked node on the way; return whether curr
+ * holds key. Must run inside an EBR critical section.
+ */
+static bool lf_list_find(LfList *list, EbrThread *t, int key, _Atomic uintptr_t **prev_out, LfNode **curr_out){
+    _Atomic uintptr_t *prev;
+    LfNode *curr;
+
+retry:
+    prev = &list->head;
+    curr = get_node(atomic_load_explicit(prev, memory_order_acquire));
+    while(curr){
+	uintptr_t next = atomic_load_explicit(&curr->next, memory_order_acquire);
+
+	if(is_marked(next)){
+	    /* fails if prev got marked or relinked under us, start over */
+	    uintptr_t expected = (uintptr_t) curr;
+	    if(!atomic_compare_exchange_strong_explicit(prev, &expected, (uintptr_t) get_node(next),
+			memory_order_acq_rel, memory_order_acquire))
+		goto retry;
+	    ebr_retire(t, curr, free);
+	    curr = get_node(next);
+	    continue;
+	}
+
+	if(curr->key >= key)
+	    break;
+	prev = &curr->next;
+	curr = get_node(next);
+    }
+
+    *prev_out = prev;
+    *curr_out = curr;
+    return curr && curr->key == key;
+}
+
+int lf_list_init(LfList *list){
+    atomic_init(&list->head, 0);
+    return 0;
+}
+
+int lf_list_destruct(LfList *list){
+    LfNode *node = get_node(atomic_load_explicit(&list->head, memory_order_acquire));
+    while(node){
+	LfNode *next = get_node(atomic_load_explicit(&node->next, memory_order_relaxed));
+	free(node);
+	node = next;
+    }
+    atomic_store_explicit(&list->head, 0, memory_order_relaxed);
+    return 0;
+}
+
+int lf_list_insert(LfList *list, EbrThread *t, int key){
+    _Atomic uintptr_t *prev;
+    LfNode *curr;
+    LfNode *node = malloc(sizeof(LfNode));
+    if(!node) return ERR_MALLOC_FAILED;
+    node->key = key;
+
+    ebr_enter(t);
+    for(;;){
+	if(lf_list_find(list, t, key, &prev, &curr)){
+	    ebr_exit(t);
+	    free(node);
+	    return ERR_DATA_EXISTS;
+	}
+
+	atomic_store_explicit(&node->next, (uintptr_t) curr, memory_order_relaxed);
+	uintptr_t expected = (uintptr_t) curr;
+	if(atomic_compare_exchange_strong_explicit(prev, &expected, (uintptr_t) node,
+		    memory_order_release, memory_order_relaxed))
+	    break;
+    }
+    ebr_exit(t);
+    return 0;
+}
+
+int lf_list_delete(LfList *list, EbrThread *t, int key){
+    _Atomic uintptr_t *prev;
+    LfNode *curr;
+
+    ebr_enter(t);
+    for(;;){
+	if(!lf_list_find(list, t, key, &prev, &curr)){
+	    ebr_exit(t);
+	    return ERR_DATA_NOT_FOUND;
+	}
+
+	/* logical delete: the one whose mark lands owns the removal */
+	uintptr_t next = atomic_load_explicit(&curr->next, memory_order_acquire);
+	if(is_marked(next))
+	    continue;
+	if(!atomic_compare_exchange_strong_explicit(&curr->next, &next, next | MARK,
+		    memory_order_acq_rel, memory_order_relaxed))
+	    continue;
+
+	/* physical delete, if it fails a find unlinks it for us */
+	uintptr_t expected = (uintptr_t) curr;
+	if(atomic_compare_exchange_strong_explicit(prev, &expected, next,
+		    memory_order_acq_rel, memory_order_relaxed))
+	    ebr_retire(t, curr, free);
+	else
+	    lf_list_find(list, t, key, &prev, &curr);
+	break;
+    }
+    ebr_exit(t);
+    return 0;
+}
+
+bool lf_list_contains(LfList *list, EbrThread *t, int key){
+    ebr_enter(t);
+    LfNode *curr = get_node(atomic_load_explicit(&list->head, memory_order_acquire));
+    while(curr && curr->key < key)
+	curr = get_node(atomic_load_explicit(&curr->next, memory_order_acquire));
+    bool found = curr && curr->key == key &&
+	!is_marked(atomic_load_explicit(&curr->next, memory_order_acquire));
+    ebr_exit(t);
+    return found;
+}
@@ -0,0 +1,40 @@
+#ifndef	    LF_LIST_H
+#define	    LF_LIST_H
+
+#include    <stdint.h>
+#include    <stdbool.h>
+#include    <stdatomic.h>
+#include    "ebr.h"
+
+#define	    ERR_MALLOC_FAILED	-1
+#define	    ERR_DATA_EXISTS	-2
+#define	    ERR_DATA_NOT_FOUND	-3
+
+/**
+ * Lock-free sorted linked list set (Harris, with Michael's unlink-on-traverse).
+ * Deleting first sets the low bit of the victim's next pointer (logical delete),
+ * which freezes it; the node is then unlinked by a CAS on its predecessor, by the
+ * deleter or by whichever traversal runs into it first. Unlinked nodes go to EBR,
+ * so a concurrent reader never touches freed memory. lf_list_contains never
+ * writes and never retries, it is wait-free.
+ */
+typedef struct lf_node {
+    int key;
+    _Atomic uintptr_t next;   /* LfNode * | 1 once the node is logically deleted */
+} LfNode;
+
+typedef struct lf_list {
+    _Atomic uintptr_t head;
+} LfList;
+
+int lf_list_init(LfList *list);
+
+int lf_list_destruct(LfList *list);     /* no thread may use the list any more */
+
+int lf_list_insert(LfList *list, EbrThread *t, int key);
+
+int lf_list_delete(LfList *list, EbrThread *t, int key);
+
+bool lf_list_contains(LfList *list, EbrThread *t, int key);
+
+#endif
@@ -0,0 +1,186 @@
+/* small ordered set under mixed workloads: Harris-Michael list vs a sorted list behind one mutex */
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <pthread.h>
+#include    <time.h>
+#include    "lf_list.h"
+
+#define	    OPS_PER_THREAD	200000u
+#define	    MAX_THREADS		16u
+#define	    KEY_RANGE		512u	/* about half of it is present at any time */
+
+/* same walk as linked_list.c, keyed by int and kept sorted */
+typedef struct locked_node {
+    int key;
+    struct locked_node *next;
+} LockedNode;
+
+typedef struct locked_list {
+    pthread_mutex_t lock;
+    LockedNode *head;
+} LockedList;
+
+typedef struct bench_arg {
+    pthread_barrier_t *barrier;
+    unsigned int seed;
+    unsigned int read_pct;
+} BenchArg;
+
+static LfList lf;
+static Ebr ebr;
+static LockedList locked;
+
+static int locked_insert(LockedList *list, int key){
+    pthread_mutex_lock(&list->lock);
+    LockedNode **p = &list->head;
+    while(*p && (*p)->key < key)
+	p = &(*p)->next;
+    if(*p && (*p)->key == key){
+	pthread_mutex_unlock(&list->lock);
+	return ERR_DATA_EXISTS;
+    }
+    LockedNode *node = malloc(sizeof(LockedNode));
+    node->key = key;
+    node->next = *p;
+    *p = node;
+    pthread_mutex_unlock(&list->lock);
+    return 0;
+}
+
+static int locked_delete(LockedList *list, int key){
+    pthread_mutex_lock(&list->lock);
+    LockedNode **p = &list->head;
+    while(*p && (*p)->key < key)
+	p = &(*p)->next;
+    if(!*p || (*p)->key != key){
+	pthread_mutex_unlock(&list->lock);
+	return ERR_DATA_NOT_FOUND;
+    }
+    LockedNode *node = *p;
+    *p = node->next;
+    pthread_mutex_unlock(&list->lock);
+    free(node);
+    return 0;
+}
+
+static bool locked_contains(LockedList *list, int key){
+    pthread_mutex_lock(&list->lock);
+    LockedNode *node = list->head;
+    while(node && node->key < key)
+	node = node->next;
+    bool found = node && node->key == key;
+    pthread_mutex_unlock(&list->lock);
+    return found;
+}
+
+static void locked_destruct(LockedList *list){
+    LockedNode *node = list->head;
+    while(node){
+	LockedNode *next = node->next;
+	free(node);
+	node = next;
+    }
+    list->head = NULL;
+}
+
+/* the rest of the ops split evenly between insert and delete, so the size stays put */
+static void *lf_worker(void *arg){
+    BenchArg *a = arg;
+    EbrThread *t = ebr_register(&ebr);
+    pthread_barrier_wait(a->barrier);
+
+    for(size_t i = 0; i < OPS_PER_THREAD; ++i){
+	unsigned int r = rand_r(&a->seed);
+	int key = r % KEY_RANGE;
+	unsigned int op = (r / KEY_RANGE) % 100;
+	if(op < a->read_pct)
+	    lf_list_contains(&lf, t, key);
+	else if(op & 1)
+	    lf_list_insert(&lf, t, key);
+	else
+	    lf_list_delete(&lf, t, key);
+    }
+    ebr_unregister(t);
+    return NULL;
+}
+
+static void *locked_worker(void *arg){
+    BenchArg *a = arg;
+    pthread_barrier_wait(a->barrier);
+
+    for(size_t i = 0; i < OPS_PER_THREAD; ++i){
+	unsigned int r = rand_r(&a->seed);
+	int key = r % KEY_RANGE;
+	unsigned int op = (r / KEY_RANGE) % 100;
+	if(op < a->read_pct)
+	    locked_contains(&locked, key);
+	else if(op & 1)
+	    locked_insert(&locked, key);
+	else
+	    locked_delete(&locked, key);
+    }
+    return NULL;
+}
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void prefill(void){
+    EbrThread *t = ebr_register(&ebr);
+    for(int key = 0; key < (int) KEY_RANGE; key += 2){
+	lf_list_insert(&lf, t, key);
+	locked_insert(&locked, key);
+    }
+    ebr_unregister(t);
+}
+
+static double run(void *(*worker)(void *), size_t nthreads, unsigned int read_pct){
+    pthread_t tids[MAX_THREADS];
+    BenchArg args[MAX_THREADS];
+    pthread_barrier_t barrier;
+    double start, elapsed;
+
+    pthread_barrier_init(&barrier, NULL, nthreads + 1);
+    for(size_t i = 0; i < nthreads; ++i){
+	args[i] = (BenchArg){ .barrier = &barrier, .seed = i + 1, .read_pct = read_pct };
+	pthread_create(&tids[i], NULL, worker, &args[i]);
+    }
+
+    start = now_sec();
+    pthread_barrier_wait(&barrier);
+    for(size_t i = 0; i < nthreads; ++i)
+	pthread_join(tids[i], NULL);
+    elapsed = now_sec() - start;
+
+    pthread_barrier_destroy(&barrier);
+    return (double) OPS_PER_THREAD * nthreads / elapsed;
+}
+
+int main(){
+    static const unsigned int read_pcts[] = { 100, 90, 50, 0 };
+
+    ebr_init(&ebr);
+    lf_list_init(&lf);
+    pthread_mutex_init(&locked.lock, NULL);
+    locked.head = NULL;
+    prefill();
+
+    printf("%6s %8s %16s %16s\n", "read%", "threads", "lock-free ops/s", "mutex ops/s");
+    for(size_t r = 0; r < sizeof(read_pcts) / sizeof(read_pcts[0]); ++r){
+	for(size_t n = 1; n <= MAX_THREADS; n <<= 1u){
+	    double l = run(lf_worker, n, read_pcts[r]);
+	    double m = run(locked_worker, n, read_pcts[r]);
+	    printf("%6u %8zu %16.0f %16.0f\n", read_pcts[r], n, l, m);
+	}
+    }
+
+    lf_list_destruct(&lf);
+    ebr_destruct(&ebr);
+    locked_destruct(&locked);
+    pthread_mutex_destroy(&locked.lock);
+    return 0;
+}
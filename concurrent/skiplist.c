@@ -0,0 +1,253 @@
+#include    <stdlib.h>
+#include    <limits.h>
+#include    "skiplist.h"
+
+#define	    MARK		1u
+#define	    is_marked(p)	((p) & MARK)
+#define	    get_node(p)		((SlNode *) ((p) & ~(uintptr_t) MARK))
+
+static _Thread_local uint32_t seed;
+
+/* 1 + number of coin flips that came up heads, so level l holds ~n / 2^l nodes */
+static unsigned int random_height(void){
+    if(!seed)
+	seed = (uint32_t) (uintptr_t) &seed | 1u;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    unsigned int height = 1;
+    uint32_t r = seed;
+    while(height < SKIPLIST_MAX_LEVEL && (r & 1u)){
+	++height;
+	r >>= 1;
+    }
+    return height;
+}
+
+static SlNode *sl_node_new(int key, unsigned int height){
+    SlNode *node = malloc(sizeof(SlNode) + height * sizeof(_Atomic uintptr_t));
+    if(!node) return NULL;
+    node->key = key;
+    node->height = height;
+    atomic_init(&node->pending, 2);
+    for(unsigned int l = 0; l < height; ++l)
+	atomic_init(&node->next[l], 0);
+    return node;
+}
+
+/**
+ * on every level fill preds[l]/succs[l] so that preds[l]->next[l] == succs[l]
+ * and succs[l] is the first node with key >= key, unlinking every marked node
+ * on the way; return whether succs[0] holds key. Nodes are not retired here,
+ * see skiplist_release. Must run inside an EBR critical section.
+ */
+static bool skiplist_find(SkipList *sl, int key, SlNode **preds, SlNode **succs){
+    unsigned int top;
+    SlNode *pred, *curr;
+
+retry:
+    top = atomic_load_explicit(&sl->level, memory_order_acquire);
+    for(unsigned int l = top; l < SKIPLIST_MAX_LEVEL; ++l){
+	preds[l] = sl->head;
+	succs[l] = NULL;
+    }
+
+    pred = sl->head;
+    for(unsigned int l = top; l-- > 0; ){
+	curr = get_node(atomic_load_explicit(&pred->next[l], memory_order_acquire));
+	while(curr){
+	    uintptr_t next = atomic_load_explicit(&curr->next[l], memory_order_acquire);
+
+	    if(is_marked(next)){
+		/* fails if pred got marked or relinked under us, start over */
+		uintptr_t expected = (uintptr_t) curr;
+		if(!atomic_compare_exchange_strong_explicit(&pred->next[l], &expected, (uintptr_t) get_node(next),
+			    memory_order_acq_rel, memory_order_acquire))
+		    goto retry;
+		curr = get_node(next);
+		continue;
+	    }
+
+	    if(curr->key >= key)
+		break;
+	    pred = curr;
+	    curr = get_node(next);
+	}
+	preds[l] = pred;
+	succs[l] = curr;
+    }
+    return succs[0] && succs[0]->key == key;
+}
+
+/**
+ * the inserter and the deleter both call this when they are done with a
+ * deleted node. The last one to arrive unlinks whatever the other may have
+ * linked back in the meantime (a marked node always sits before any live
+ * node with the same key, so the find walks over it on every level) and
+ * only then retires it, so no level can reach it once it is in EBR.
+ */
+static void skiplist_release(SkipList *sl, EbrThread *t, SlNode *node){
+    SlNode *preds[SKIPLIST_MAX_LEVEL], *succs[SKIPLIST_MAX_LEVEL];
+
+    if(atomic_fetch_sub_explicit(&node->pending, 1, memory_order_acq_rel) != 1)
+	return;
+    skiplist_find(sl, node->key, preds, succs);
+    ebr_retire(t, node, free);
+}
+
+int skiplist_init(SkipList *sl){
+    sl->head = sl_node_new(INT_MIN, SKIPLIST_MAX_LEVEL);
+    if(!sl->head) return ERR_MALLOC_FAILED;
+    atomic_init(&sl->level, 1);
+    return 0;
+}
+
+int skiplist_destruct(SkipList *sl){
+    SlNode *node = get_node(atomic_load_explicit(&sl->head->next[0], memory_order_acquire));
+    while(node){
+	SlNode *next = get_node(atomic_load_explicit(&node->next[0], memory_order_relaxed));
+	free(node);
+	node = next;
+    }
+    free(sl->head);
+    sl->head = NULL;
+    return 0;
+}
+
+int skiplist_insert(SkipList *sl, EbrThread *t, int key){
+    SlNode *preds[SKIPLIST_MAX_LEVEL], *succs[SKIPLIST_MAX_LEVEL];
+    unsigned int height = random_height();
+    SlNode *node = sl_node_new(key, height);
+    if(!node) return ERR_MALLOC_FAILED;
+
+    /* raise the search start first, a find from below would miss the new levels */
+    unsigned int top = atomic_load_explicit(&sl->level, memory_order_relaxed);
+    while(top < height &&
+	    !atomic_compare_exchange_weak_explicit(&sl->level, &top, height,
+		memory_order_acq_rel, memory_order_relaxed))
+	;
+
+    ebr_enter(t);
+    /* level 0 is where the key becomes visible */
+    for(;;){
+	if(skiplist_find(sl, key, preds, succs)){
+	    ebr_exit(t);
+	    free(node);
+	    return ERR_DATA_EXISTS;
+	}
+
+	for(unsigned int l = 0; l < height; ++l)
+	    atomic_store_explicit(&node->next[l], (uintptr_t) succs[l], memory_order_relaxed);
+	uintptr_t expected = (uintptr_t) succs[0];
+	if(atomic_compare_exchange_strong_explicit(&preds[0]->next[0], &expected, (uintptr_t) node,
+		    memory_order_release, memory_order_relaxed))
+	    break;
+    }
+
+    /* the upper levels are only shortcuts, stop as soon as a deleter marks the node */
+    for(unsigned int l = 1; l < height; ++l){
+	for(;;){
+	    uintptr_t next = atomic_load_explicit(&node->next[l], memory_order_acquire);
+	    if(is_marked(next))
+		goto done;
+	    if(get_node(next) != succs[l] &&
+		    !atomic_compare_exchange_strong_explicit(&node->next[l], &next, (uintptr_t) succs[l],
+			memory_order_acq_rel, memory_order_relaxed))
+		goto done;
+
+	    uintptr_t expected = (uintptr_t) succs[l];
+	    if(atomic_compare_exchange_strong_explicit(&preds[l]->next[l], &expected, (uintptr_t) node,
+			memory_order_release, memory_order_relaxed))
+		break;
+	    if(!skiplist_find(sl, key, preds, succs) || succs[0] != node)
+		goto done;
+	}
+    }
+
+done:
+    skiplist_release(sl, t, node);
+    ebr_exit(t);
+    return 0;
+}
+
+int skiplist_delete(SkipList *sl, EbrThread *t, int key){
+    SlNode *preds[SKIPLIST_MAX_LEVEL], *succs[SKIPLIST_MAX_LEVEL];
+
+    ebr_enter(t);
+    if(!skiplist_find(sl, key, preds, succs)){
+	ebr_exit(t);
+	return ERR_DATA_NOT_FOUND;
+    }
+    SlNode *node = succs[0];
+
+    /* freeze the upper levels top-down, whoever marks them is irrelevant */
+    for(unsigned int l = node->height; l-- > 1; ){
+	uintptr_t next = atomic_load_explicit(&node->next[l], memory_order_acquire);
+	while(!is_marked(next) &&
+		!atomic_compare_exchange_weak_explicit(&node->next[l], &next, next | MARK,
+		    memory_order_acq_rel, memory_order_acquire))
+	    ;
+    }
+
+    /* the mark on level 0 is the delete itself, only one thread lands it */
+    uintptr_t next = atomic_load_explicit(&node->next[0], memory_order_acquire);
+    for(;;){
+	if(is_marked(next)){
+	    ebr_exit(t);
+	    return ERR_DATA_NOT_FOUND;
+	}
+	if(atomic_compare_exchange_weak_explicit(&node->next[0], &next, next | MARK,
+		    memory_order_acq_rel, memory_order_acquire))
+	    break;
+    }
+
+    skiplist_find(sl, key, preds, succs);
+    skiplist_release(sl, t, node);
+    ebr_exit(t);
+    return 0;
+}
+
+/* read-only descent that steps over marked nodes instead of unlinking them */
+static SlNode *skiplist_lower_bound(SkipList *sl, int key){
+    SlNode *pred = sl->head, *curr = NULL;
+
+    for(unsigned int l = atomic_load_explicit(&sl->level, memory_order_acquire); l-- > 0; ){
+	curr = get_node(atomic_load_explicit(&pred->next[l], memory_order_acquire));
+	while(curr){
+	    uintptr_t next = atomic_load_explicit(&curr->next[l], memory_order_acquire);
+	    if(!is_marked(next) && curr->key >= key)
+		break;
+	    if(!is_marked(next))
+		pred = curr;
+	    curr = get_node(next);
+	}
+    }
+    return curr;
+}
+
+bool skiplist_search(SkipList *sl, EbrThread *t, int key){
+    ebr_enter(t);
+    SlNode *node = skiplist_lower_bound(sl, key);
+    bool found = node && node->key == key;
+    ebr_exit(t);
+    return found;
+}
+
+size_t skiplist_range(SkipList *sl, EbrThread *t, int lo, int hi, skiplist_visit_fn visit, void *arg){
+    size_t count = 0;
+
+    ebr_enter(t);
+    SlNode *node = skiplist_lower_bound(sl, lo);
+    while(node && node->key <= hi){
+	uintptr_t next = atomic_load_explicit(&node->next[0], memory_order_acquire);
+	if(!is_marked(next)){
+	    if(visit)
+		visit(node->key, arg);
+	    ++count;
+	}
+	node = get_node(next);
+    }
+    ebr_exit(t);
+    return count;
+}
@@ -0,0 +1,50 @@
+#ifndef	    SKIPLIST_H
+#define	    SKIPLIST_H
+
+#include    <stdint.h>
+#include    <stdbool.h>
+#include    <stdatomic.h>
+#include    "ebr.h"
+
+#define	    ERR_MALLOC_FAILED	-1
+#define	    ERR_DATA_EXISTS	-2
+#define	    ERR_DATA_NOT_FOUND	-3
+
+#define	    SKIPLIST_MAX_LEVEL	24u
+
+/**
+ * Lock-free skip list keyed by int (Fraser; Herlihy & Shavit). Every level is a
+ * Harris list: a node is deleted by marking its next pointers top-down, the
+ * mark on level 0 decides who deleted it, and traversals unlink marked nodes.
+ * A node and its tower are one allocation. The inserter may still be linking
+ * upper levels while the node is deleted, so whichever of the two finishes
+ * last unlinks what is left and retires the node to EBR.
+ */
+typedef struct sl_node {
+    int key;
+    unsigned int height;
+    _Atomic unsigned int pending;   /* inserter + deleter still working on the node */
+    _Atomic uintptr_t next[];       /* SlNode * | 1 once deleted at that level */
+} SlNode;
+
+typedef struct skiplist {
+    SlNode *head;                   /* sentinel, SKIPLIST_MAX_LEVEL high */
+    _Atomic unsigned int level;     /* highest tower so far, searches start there */
+} SkipList;
+
+typedef void (*skiplist_visit_fn)(int key, void *arg);
+
+int skiplist_init(SkipList *sl);
+
+int skiplist_destruct(SkipList *sl);    /* no thread may use the list any more */
+
+int skiplist_insert(SkipList *sl, EbrThread *t, int key);
+
+int skiplist_delete(SkipList *sl, EbrThread *t, int key);
+
+bool skiplist_search(SkipList *sl, EbrThread *t, int key);
+
+/* visit every key in [lo, hi] in ascending order, return how many */
+size_t skiplist_range(SkipList *sl, EbrThread *t, int lo, int hi, skiplist_visit_fn visit, void *arg);
+
+#endif
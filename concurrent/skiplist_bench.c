@@ -0,0 +1,160 @@
+/* ordered int set under mixed workloads: lock-free skip list vs the AVL tree behind one rwlock */
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <pthread.h>
+#include    <time.h>
+#include    "skiplist.h"
+#include    "../advanced_trees/avl.h"
+
+#define	    OPS_PER_THREAD	200000u
+#define	    MAX_THREADS		16u
+#define	    KEY_RANGE		(1u << 16)	/* about half of it is present at any time */
+#define	    RANGE_SPAN		32		/* keys covered by one range query */
+
+typedef struct locked_avl {
+    pthread_rwlock_t lock;
+    AVL tree;
+} LockedAVL;
+
+typedef struct bench_arg {
+    pthread_barrier_t *barrier;
+    unsigned int seed;
+    unsigned int read_pct;
+    unsigned int range_pct;		/* share of the reads that are range queries */
+} BenchArg;
+
+static SkipList sl;
+static Ebr ebr;
+static LockedAVL locked;
+
+static size_t avl_count_range(Node *node, int lo, int hi){
+    size_t count = 0;
+    while(node){
+	if(node->val < lo){
+	    node = node->right;
+	}else if(node->val > hi){
+	    node = node->left;
+	}else{
+	    count += 1 + avl_count_range(node->left, lo, hi);
+	    node = node->right;
+	}
+    }
+    return count;
+}
+
+/* the rest of the ops split evenly between insert and delete, so the size stays put */
+static void *sl_worker(void *arg){
+    BenchArg *a = arg;
+    EbrThread *t = ebr_register(&ebr);
+    pthread_barrier_wait(a->barrier);
+
+    for(size_t i = 0; i < OPS_PER_THREAD; ++i){
+	unsigned int r = rand_r(&a->seed);
+	int key = r % KEY_RANGE;
+	unsigned int op = (r / KEY_RANGE) % 100;
+	if(op < a->read_pct){
+	    if(op < a->range_pct)
+		skiplist_range(&sl, t, key, key + RANGE_SPAN - 1, NULL, NULL);
+	    else
+		skiplist_search(&sl, t, key);
+	}else if(op & 1){
+	    skiplist_insert(&sl, t, key);
+	}else{
+	    skiplist_delete(&sl, t, key);
+	}
+    }
+    ebr_unregister(t);
+    return NULL;
+}
+
+static void *avl_worker(void *arg){
+    BenchArg *a = arg;
+    pthread_barrier_wait(a->barrier);
+
+    for(size_t i = 0; i < OPS_PER_THREAD; ++i){
+	unsigned int r = rand_r(&a->seed);
+	int key = r % KEY_RANGE;
+	unsigned int op = (r / KEY_RANGE) % 100;
+	if(op < a->read_pct){
+	    pthread_rwlock_rdlock(&locked.lock);
+	    if(op < a->range_pct)
+		avl_count_range(locked.tree.root, key, key + RANGE_SPAN - 1);
+	    else
+		avl_search(&locked.tree, key);
+	    pthread_rwlock_unlock(&locked.lock);
+	}else{
+	    pthread_rwlock_wrlock(&locked.lock);
+	    if(op & 1)
+		avl_insert(&locked.tree, key);
+	    else
+		avl_delete(&locked.tree, key);
+	    pthread_rwlock_unlock(&locked.lock);
+	}
+    }
+    return NULL;
+}
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void prefill(void){
+    EbrThread *t = ebr_register(&ebr);
+    for(int key = 0; key < (int) KEY_RANGE; key += 2){
+	skiplist_insert(&sl, t, key);
+	avl_insert(&locked.tree, key);
+    }
+    ebr_unregister(t);
+}
+
+static double run(void *(*worker)(void *), size_t nthreads, unsigned int read_pct, unsigned int range_pct){
+    pthread_t tids[MAX_THREADS];
+    BenchArg args[MAX_THREADS];
+    pthread_barrier_t barrier;
+    double start, elapsed;
+
+    pthread_barrier_init(&barrier, NULL, nthreads + 1);
+    for(size_t i = 0; i < nthreads; ++i){
+	args[i] = (BenchArg){ .barrier = &barrier, .seed = i + 1, .read_pct = read_pct, .range_pct = range_pct };
+	pthread_create(&tids[i], NULL, worker, &args[i]);
+    }
+
+    start = now_sec();
+    pthread_barrier_wait(&barrier);
+    for(size_t i = 0; i < nthreads; ++i)
+	pthread_join(tids[i], NULL);
+    elapsed = now_sec() - start;
+
+    pthread_barrier_destroy(&barrier);
+    return (double) OPS_PER_THREAD * nthreads / elapsed;
+}
+
+int main(){
+    static const unsigned int read_pcts[] = { 100, 90, 50, 0 };
+
+    ebr_init(&ebr);
+    skiplist_init(&sl);
+    pthread_rwlock_init(&locked.lock, NULL);
+    avl_init(&locked.tree);
+    prefill();
+
+    printf("%6s %7s %8s %16s %16s\n", "read%", "range%", "threads", "skip list ops/s", "rwlock AVL ops/s");
+    for(size_t r = 0; r < sizeof(read_pcts) / sizeof(read_pcts[0]); ++r){
+	for(unsigned int range_pct = 0; range_pct <= 10 && range_pct <= read_pcts[r]; range_pct += 10){
+	    for(size_t n = 1; n <= MAX_THREADS; n <<= 1u){
+		double s = run(sl_worker, n, read_pcts[r], range_pct);
+		double a = run(avl_worker, n, read_pcts[r], range_pct);
+		printf("%6u %7u %8zu %16.0f %16.0f\n", read_pcts[r], range_pct, n, s, a);
+	    }
+	}
+    }
+
+    skiplist_destruct(&sl);
+    ebr_destruct(&ebr);
+    avl_destroy(&locked.tree);
+    pthread_rwlock_destroy(&locked.lock);
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include    <stdlib.h>
+#include    <sched.h>
+#include    <unistd.h>
+#include    "task_pool.h"
+
+#define	    IDLE_SPINS		64u	/* failed scans before parking */
+
+static _Thread_local Worker *self;
+
+/**
+ * bump the epoch, then wake the parked threads if there are any. Both sides
+ * are seq_cst: either the waker sees the new sleeper, or the sleeper sees
+ * the new epoch before it waits, so a wakeup is never lost.
+ */
+static void pool_wake(TaskPool *pool){
+    atomic_fetch_add_explicit(&pool->epoch, 1, memory_order_seq_cst);
+    if(atomic_load_explicit(&pool->sleepers, memory_order_seq_cst)){
+	pthread_mutex_lock(&pool->lock);
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static void task_run(TaskPool *pool, Task *task){
+    task->fn(task->arg);
+    /* the spawner may return right after seeing done, do not touch task after this */
+    atomic_store_explicit(&task->done, 1, memory_order_release);
+    pool_wake(pool);
+}
+
+static Task *task_steal(TaskPool *pool, Worker *w){
+    size_t n = pool->nworkers;
+    size_t start;
+
+    if(w){
+	w->seed ^= w->seed << 13;
+	w->seed ^= w->seed >> 17;
+	w->seed ^= w->seed << 5;
+	start = w->seed % n;
+    } else
+	start = 0;
+
+    for(size_t i = 0; i < n; ++i){
+	Worker *victim = &pool->workers[(start + i) % n];
+	if(victim == w) continue;
+	Task *task = ws_deque_steal(&victim->dq);
+	if(task) return task;
+    }
+    return NULL;
+}
+
+/* yield for a while, then sleep until the epoch read before the failed scan moves (or done is set) */
+static void idle_wait(TaskPool *pool, unsigned int *fails, size_t epoch, atomic_int *done){
+    if(++(*fails) < IDLE_SPINS){
+	sched_yield();
+	return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add_explicit(&pool->sleepers, 1, memory_order_seq_cst);
+    while(atomic_load_explicit(&pool->epoch, memory_order_seq_cst) == epoch &&
+	    !atomic_load_explicit(&pool->stop, memory_order_acquire) &&
+	    !(done && atomic_load_explicit(done, memory_order_acquire)))
+	pthread_cond_wait(&pool->wake, &pool->lock);
+    atomic_fetch_sub_explicit(&pool->sleepers, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&pool->lock);
+    *fails = 0;
+}
+
+static void *worker_main(void *arg){
+    Worker *w = arg;
+    TaskPool *pool = w->pool;
+    unsigned int fails = 0;
+    self = w;
+
+    while(!atomic_load_explicit(&pool->stop, memory_order_acquire)){
+	size_t epoch = atomic_load_explicit(&pool->epoch, memory_order_seq_cst);
+	Task *task = ws_deque_pop(&w->dq);
+	if(!task) task = task_steal(pool, w);
+
+	if(task){
+	    task_run(pool, task);
+	    fails = 0;
+	} else
+	    idle_wait(pool, &fails, epoch, NULL);
+    }
+    return NULL;
+}
+
+int task_pool_init(TaskPool *pool, size_t nthreads){
+    if(nthreads == 0){
+	long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+	nthreads = ncpu > 0 ? (size_t) ncpu : 1;
+    }
+
+    pool->workers = calloc(nthreads, sizeof(Worker));
+    if(!pool->workers) return -1;
+    pool->nworkers = nthreads;
+    atomic_init(&pool->stop, 0);
+    atomic_init(&pool->epoch, 0);
+    atomic_init(&pool->sleepers, 0);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    for(size_t i = 0; i < nthreads; ++i){
+	Worker *w = &pool->workers[i];
+	w->pool = pool;
+	w->id = i;
+	w->seed = (unsigned int) (i * 2654435761u) | 1u;
+	if(ws_deque_init(&w->dq) < 0) goto err;
+    }
+
+    /* the caller is worker 0 */
+    self = &pool->workers[0];
+    pool->workers[0].tid = pthread_self();
+    for(size_t i = 1; i < nthreads; ++i){
+	if(pthread_create(&pool->workers[i].tid, NULL, worker_main, &pool->workers[i])){
+	    /* workers from i on never ran, destruct only joins and frees the first i */
+	    for(size_t j = i; j < nthreads; ++j)
+		ws_deque_destruct(&pool->workers[j].dq);
+	    pool->nworkers = i;
+	    task_pool_destruct(pool);
+	    return -1;
+	}
+    }
+
+    return 0;
+
+err:
+    for(size_t i = 0; i < nthreads; ++i)
+	if(atomic_load_explicit(&pool->workers[i].dq.array, memory_order_relaxed))
+	    ws_deque_destruct(&pool->workers[i].dq);
+    free(pool->workers);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    self = NULL;
+    return -1;
+}
+
+int task_pool_destruct(TaskPool *pool){
+    atomic_store_explicit(&pool->stop, 1, memory_order_release);
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for(size_t i = 1; i < pool->nworkers; ++i)
+	pthread_join(pool->workers[i].tid, NULL);
+
+    if(self && self->pool == pool)
+	self = NULL;
+
+    for(size_t i = 0; i < pool->nworkers; ++i)
+	ws_deque_destruct(&pool->workers[i].dq);
+    free(pool->workers);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    return 0;
+}
+
+void task_spawn(TaskPool *pool, Task *task, task_fn fn, void *arg){
+    Worker *w = self;
+    task->fn = fn;
+    task->arg = arg;
+    atomic_init(&task->done, 0);
+
+    /* not one of our workers or the deque cannot grow: run it inline */
+    if(!w || w->pool != pool || ws_deque_push(&w->dq, task) < 0)
+	task_run(pool, task);
+    else
+	pool_wake(pool);
+}
+
+void task_sync(TaskPool *pool, Task *task){
+    Worker *w = self;
+    unsigned int fails = 0;
+
+    /* help out instead of blocking, the task is either below us in the deque or stolen */
+    while(!atomic_load_explicit(&task->done, memory_order_acquire)){
+	size_t epoch = atomic_load_explicit(&pool->epoch, memory_order_seq_cst);
+	Task *t = (w && w->pool == pool) ? ws_deque_pop(&w->dq) : NULL;
+	if(!t) t = task_steal(pool, w);
+
+	if(t){
+	    task_run(pool, t);
+	    fails = 0;
+	} else
+	    idle_wait(pool, &fails, epoch, &task->done);
+    }
+}
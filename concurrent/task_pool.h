@@ -0,0 +1,52 @@
+#ifndef	    TASK_POOL_H
+#define	    TASK_POOL_H
+
+#include    <stddef.h>
+#include    <stdatomic.h>
+#include    <pthread.h>
+#include    "ws_deque.h"
+
+/**
+ * Fork/join pool, one Chase-Lev deque per worker.
+ * The thread calling task_pool_init becomes worker 0, so it can spawn right away.
+ * Task lives in the spawner's stack frame: every task_spawn must be
+ * matched with task_sync on the same task before the frame returns.
+ */
+typedef void (*task_fn)(void *arg);
+
+typedef struct task {
+    task_fn fn;
+    void *arg;
+    atomic_int done;
+} Task;
+
+typedef struct task_pool TaskPool;
+
+typedef struct worker {
+    TaskPool *pool;
+    WsDeque dq;
+    pthread_t tid;
+    size_t id;
+    unsigned int seed;       /* victim selection */
+} Worker;
+
+/* idle threads park on wake until epoch moves: a task was pushed or finished */
+struct task_pool {
+    Worker *workers;
+    size_t nworkers;
+    atomic_bool stop;
+    atomic_size_t epoch;
+    atomic_uint sleepers;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+};
+
+int task_pool_init(TaskPool *pool, size_t nthreads);   /* nthreads == 0 means one per online cpu */
+
+int task_pool_destruct(TaskPool *pool);
+
+void task_spawn(TaskPool *pool, Task *task, task_fn fn, void *arg);
+
+void task_sync(TaskPool *pool, Task *task);
+
+#endif
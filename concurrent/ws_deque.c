@@ -0,0 +1,100 @@
+#include    <stdlib.h>
+#include    "ws_deque.h"
+
+static WsArray *ws_array_new(size_t size){
+    WsArray *a = malloc(sizeof(WsArray) + sizeof(void *) * size);
+    if(!a) return NULL;
+    a->size = size;
+    a->prev = NULL;
+    return a;
+}
+
+/* double the array, old one is kept on the prev chain until destruct */
+static WsArray *ws_array_grow(WsArray *a, long top, long bottom){
+    WsArray *new_a = ws_array_new(a->size << 1u);
+    if(!new_a) return NULL;
+
+    for(long i = top; i < bottom; ++i){
+	void *item = atomic_load_explicit(&a->buf[i & (a->size - 1)], memory_order_relaxed);
+	atomic_store_explicit(&new_a->buf[i & (new_a->size - 1)], item, memory_order_relaxed);
+    }
+    new_a->prev = a;
+    return new_a;
+}
+
+int ws_deque_init(WsDeque *dq){
+    WsArray *a = ws_array_new(WS_DEQUE_DFT_CAPACITY);
+    if(!a) return -1;
+    atomic_init(&dq->top, 0);
+    atomic_init(&dq->bottom, 0);
+    atomic_init(&dq->array, a);
+    return 0;
+}
+
+int ws_deque_destruct(WsDeque *dq){
+    WsArray *a = atomic_load_explicit(&dq->array, memory_order_relaxed);
+    while(a){
+	WsArray *prev = a->prev;
+	free(a);
+	a = prev;
+    }
+    atomic_store_explicit(&dq->array, NULL, memory_order_relaxed);
+    return 0;
+}
+
+int ws_deque_push(WsDeque *dq, void *item){
+    long b = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&dq->top, memory_order_acquire);
+    WsArray *a = atomic_load_explicit(&dq->array, memory_order_relaxed);
+
+    if(b - t > (long) a->size - 1){ /* full */
+	WsArray *new_a = ws_array_grow(a, t, b);
+	if(!new_a) return -1;
+	atomic_store_explicit(&dq->array, new_a, memory_order_release);
+	a = new_a;
+    }
+    // invariant: a has a free slot at b
+    atomic_store_explicit(&a->buf[b & (a->size - 1)], item, memory_order_relaxed);
+    atomic_store_explicit(&dq->bottom, b + 1, memory_order_release); /* publish item to thieves */
+    return 0;
+}
+
+void *ws_deque_pop(WsDeque *dq){
+    long b = atomic_load_explicit(&dq->bottom, memory_order_relaxed) - 1;
+    WsArray *a = atomic_load_explicit(&dq->array, memory_order_relaxed);
+    atomic_store_explicit(&dq->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&dq->top, memory_order_relaxed);
+    void *item = NULL;
+
+    if(t <= b){
+	item = atomic_load_explicit(&a->buf[b & (a->size - 1)], memory_order_relaxed);
+	if(t == b){ /* last item, race against thieves */
+	    if(!atomic_compare_exchange_strong_explicit(&dq->top, &t, t + 1,
+			memory_order_seq_cst, memory_order_relaxed))
+		item = NULL;
+	    atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+	}
+    } else { /* empty */
+	atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+    }
+
+    return item;
+}
+
+void *ws_deque_steal(WsDeque *dq){
+    long t = atomic_load_explicit(&dq->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+
+    if(t >= b)
+	return NULL;
+
+    WsArray *a = atomic_load_explicit(&dq->array, memory_order_acquire);
+    void *item = atomic_load_explicit(&a->buf[t & (a->size - 1)], memory_order_relaxed);
+    if(!atomic_compare_exchange_strong_explicit(&dq->top, &t, t + 1,
+		memory_order_seq_cst, memory_order_relaxed))
+	return NULL;
+
+    return item;
+}
@@ -0,0 +1,36 @@
+#ifndef	    WS_DEQUE_H
+#define	    WS_DEQUE_H
+
+#include    <stddef.h>
+#include    <stdatomic.h>
+
+#define	    WS_DEQUE_DFT_CAPACITY	64u
+
+/**
+ * Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli, PPoPP'13).
+ * The owner thread pushes and pops at the bottom, any other thread steals
+ * from the top. Items must not be NULL since NULL means "nothing".
+ */
+typedef struct ws_array {
+    size_t size;                 /* power of 2 */
+    struct ws_array *prev;       /* retired array, thieves may still read it */
+    _Atomic(void *) buf[];
+} WsArray;
+
+typedef struct ws_deque {
+    _Atomic long top;
+    _Atomic long bottom;
+    _Atomic(WsArray *) array;
+} WsDeque;
+
+int ws_deque_init(WsDeque *dq);
+
+int ws_deque_destruct(WsDeque *dq);
+
+int ws_deque_push(WsDeque *dq, void *item);   /* owner only */
+
+void *ws_deque_pop(WsDeque *dq);              /* owner only */
+
+void *ws_deque_steal(WsDeque *dq);            /* any thread, NULL if empty or lost the race */
+
+#endif
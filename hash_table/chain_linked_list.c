@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include "../alloc/slab.h"
  
 #define BUF_SIZE 1024
 #define MAP_CAP_BITS 5u
@@ -15,6 +16,7 @@ typedef struct {
     Entry *buckets; 
     size_t capacity;
     size_t size; 
+    NodeAllocator *alloc;   /* chained entries come from here, NULL is malloc */
 } HashMap;
  
  
@@ -90,6 +92,7 @@ int map_init(HashMap *map, unsigned int cap_bits) {
     map->buckets = calloc(capacity, sizeof(Entry)); // 分配「全為 0」的空間
     map->capacity = capacity;
     map->size = 0;
+    map->alloc = NULL;
  
     return -(map->buckets == NULL);
 }
@@ -144,7 +147,7 @@ int map_put(HashMap *map, const char *key, int value){
 	    ptr = &e->next;
 	}
 
-	if(!(*ptr = malloc(sizeof(Entry)))) return -1;
+	if(!(*ptr = node_alloc(map->alloc, sizeof(Entry)))) return -1;
 	if(!((*ptr)->key = strdup(key))) return -1;
 	(*ptr)->value = value;
 	(*ptr)->next = NULL;
@@ -187,7 +190,7 @@ void map_destroy(HashMap *map){
 		next = next->next;
 		
 		free(curr->key);
-		free(curr);
+		node_free(map->alloc, curr, sizeof(Entry));
 	    }
 	    free(bucket.key);
 	}
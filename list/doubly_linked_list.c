@@ -1,6 +1,13 @@
 #include    <stdio.h>
 #include    <stdlib.h>
 #include    <string.h>
+#include    <stdint.h>
+#include    <pthread.h>
+#include    "../alloc/slab.h"
+#include    "list_sort.h"
+
+#define	    ID_INDEX_DFT_CAPACITY	16u	/* power of 2 */
+#define	    ID_INDEX_LOAD_FACTOR	0.75
 
 typedef struct node Node;
 struct node {
@@ -9,9 +16,24 @@ struct node {
     Node *prev;
 };
 
+/* open addressing on id with linear probing, node == NULL marks a free slot */
+typedef struct id_slot {
+    int id;
+    Node *node;
+} IdSlot;
+
+typedef struct id_index {
+    IdSlot *slots;
+    size_t capacity;
+    size_t size;
+} IdIndex;
+
+/* circular: head->prev is the tail, a single node points to itself */
 typedef struct list {
     Node *head;
     size_t size;
+    IdIndex *index;   /* NULL unless list_index_enable, then ids must be unique */
+    NodeAllocator *alloc;   /* NULL is malloc, set after list_init to opt in */
 } List;
 
 typedef struct user {
@@ -19,15 +41,25 @@ typedef struct user {
     int id;
 } User;
 
+typedef int (*list_cmp_fn)(const Node *a, const Node *b);
+
+LIST_SORT_DEFINE(list, Node, next)
+
 int list_init(List *list);
-Node *node_create(void *data);
+Node *node_create(NodeAllocator *a, void *data);
 int list_push_back(List *list, void *data);
 int list_push_front(List *list, void *data);
 int list_delete(List *list, int id);
+int list_index_enable(List *list);
+void list_index_disable(List *list);
+int list_sort(List *list, list_cmp_fn cmp);
+int list_sort_parallel(List *list, list_cmp_fn cmp, unsigned int nthreads);
+static int list_cmp_id(const Node *a, const Node *b);
 
 int main(){
     List list;
     list_init(&list);
+    list_index_enable(&list);
 
     list_push_back(&list, &(User){
 	.name = "yik ming",
@@ -51,6 +83,7 @@ int main(){
 
     list_delete(&list, 12);
     list_delete(&list, 11);
+    list_sort(&list, list_cmp_id);
 
     Node *ptr = list.head;
     while(ptr){
@@ -59,126 +92,228 @@ int main(){
 	ptr = ptr->next;
 	if(ptr == list.head) break;
     }
+    list_index_disable(&list);
 }
 
 int list_init(List *list){
     list->head = NULL;
     list->size = 0;
+    list->index = NULL;
+    list->alloc = NULL;
     return 0;
 }
 
-Node *node_create(void *data){
-    Node *new_node = malloc(sizeof(Node));
+Node *node_create(NodeAllocator *a, void *data){
+    Node *new_node = node_alloc(a, sizeof(Node));
+    if(!new_node) return NULL;
     new_node->data = data;
     new_node->next = NULL;
     new_node->prev = NULL;
     return new_node;
 }
 
-int list_push_back(List *list, void *data){
-    Node *new_node = node_create(data);
-    if(!new_node) return -1;
+/* fibonacci hashing, the high bits of the product are the best mixed */
+static size_t id_hash(IdIndex *index, int id){
+    return (size_t) (((uint64_t) (uint32_t) id * 0x9e3779b97f4a7c15ull) >> 32) & (index->capacity - 1);
+}
 
-    list->size++;
+static IdSlot *id_index_slot(IdIndex *index, int id){
+    size_t i = id_hash(index, id);
+    while(index->slots[i].node && index->slots[i].id != id)
+	i = (i + 1) & (index->capacity - 1);
+    return &index->slots[i];
+}
 
-    if(!list->head){
-	list->head = new_node;
-	return 0;
+static int id_index_rehash(IdIndex *index){
+    IdSlot *old_slots = index->slots;
+    size_t old_cap = index->capacity;
+
+    IdSlot *slots = calloc(old_cap << 1u, sizeof(IdSlot));
+    if(!slots) return -1;
+    index->slots = slots;
+    index->capacity = old_cap << 1u;
+
+    for(size_t i = 0; i < old_cap; ++i)
+	if(old_slots[i].node)
+	    *id_index_slot(index, old_slots[i].id) = old_slots[i];
+    free(old_slots);
+    return 0;
+}
+
+static int id_index_insert(IdIndex *index, Node *node){
+    if((double) (index->size + 1) / (double) index->capacity >= ID_INDEX_LOAD_FACTOR &&
+	    id_index_rehash(index) < 0)
+	return -1;
+
+    User *u = node->data;
+    IdSlot *slot = id_index_slot(index, u->id);
+    if(slot->node) return -1;   /* duplicate id */
+    slot->id = u->id;
+    slot->node = node;
+    index->size++;
+    return 0;
+}
+
+/* backward shift deletion: pull later entries of the probe run into the hole, no tombstones */
+static void id_index_remove(IdIndex *index, IdSlot *slot){
+    size_t mask = index->capacity - 1;
+    size_t hole = slot - index->slots;
+
+    for(size_t i = (hole + 1) & mask; index->slots[i].node; i = (i + 1) & mask){
+	size_t home = id_hash(index, index->slots[i].id);
+	/* entry i may move to hole only if hole lies on its probe path home .. i */
+	if(((i - home) & mask) >= ((i - hole) & mask)){
+	    index->slots[hole] = index->slots[i];
+	    hole = i;
+	}
     }
+    index->slots[hole].node = NULL;
+    index->size--;
+}
 
-    Node *ptr = list->head;
-    while(ptr->next && ptr->next != list->head)
-	ptr = ptr->next;
+/* index every node already in the list, from now on push and delete keep it up to date */
+int list_index_enable(List *list){
+    if(list->index) return 0;
 
-    ptr->next = new_node;
-    new_node->prev = ptr; 
+    IdIndex *index = malloc(sizeof(IdIndex));
+    if(!index) return -1;
+    index->capacity = ID_INDEX_DFT_CAPACITY;
+    index->size = 0;
+    if(!(index->slots = calloc(index->capacity, sizeof(IdSlot)))){
+	free(index);
+	return -1;
+    }
 
-    /* implement circular linked list */
-    new_node->next = list->head;
-    list->head->prev = new_node;
+    Node *ptr = list->head;
+    for(size_t i = 0; i < list->size; ++i, ptr = ptr->next){
+	if(id_index_insert(index, ptr) < 0){
+	    free(index->slots);
+	    free(index);
+	    return -1;
+	}
+    }
+    list->index = index;
     return 0;
 }
 
-int list_push_front(List *list, void *data){
-    Node *new_node = node_create(data);
-    if(!new_node) return -1;
+void list_index_disable(List *list){
+    if(!list->index) return;
+    free(list->index->slots);
+    free(list->index);
+    list->index = NULL;
+}
+
+/* link new_node in front of head, that is after the tail */
+static int list_link(List *list, Node *new_node){
+    if(list->index && id_index_insert(list->index, new_node) < 0)
+	return -1;
 
     list->size++;
 
     if(!list->head){
+	new_node->next = new_node->prev = new_node;
 	list->head = new_node;
 	return 0;
     }
 
-    /* find the last node to implement circular linked list */
-    Node *ptr = list->head;
-    while(ptr->next && ptr->next != list->head)
-	ptr = ptr->next;
-
-    ptr->next = new_node;
-    new_node->prev = ptr;
-
-    /* implement circular linked list */
+    Node *tail = list->head->prev;
+    new_node->prev = tail;
     new_node->next = list->head;
+    tail->next = new_node;
     list->head->prev = new_node;
-    list->head = new_node;
     return 0;
 }
 
-int list_delete(List *list, int id){
-    Node *ptr = list->head;
-    User *u = ptr->data;
+int list_push_back(List *list, void *data){
+    Node *new_node = node_create(list->alloc, data);
+    if(!new_node) return -1;
+
+    if(list_link(list, new_node) < 0){
+	node_free(list->alloc, new_node, sizeof(Node));
+	return -1;
+    }
+    return 0;
+}
+
+int list_push_front(List *list, void *data){
+    Node *new_node = node_create(list->alloc, data);
+    if(!new_node) return -1;
+
+    if(list_link(list, new_node) < 0){
+	node_free(list->alloc, new_node, sizeof(Node));
+	return -1;
+    }
+    list->head = new_node;
+    return 0;
+}
 
-    /* check the node which the list has only 1 node*/
-    if(u->id == id && list->size == 1){
-//	free(u->name);
-	free(ptr);
+static void list_unlink(List *list, Node *ptr){
+    if(ptr->next == ptr){
 	list->head = NULL;
-	return 0;
+    } else {
+	ptr->prev->next = ptr->next;
+	ptr->next->prev = ptr->prev;
+	if(list->head == ptr)
+	    list->head = ptr->next;
     }
-    
-    /* check the first node which the list has at least 2 nodes*/
-    if(u->id == id){
-	Node *prev = ptr->prev;
-	Node *next = ptr->next;
-//	free(u->name);
-	free(ptr);
-	next->prev = prev;
-	prev->next = next;
-	list->head = next;
-	list->size--;
-	return 0;
-    } 
-
-    /* check the last node which the list has at least 2 nodes */
-    ptr = ptr->prev;
-    u = ptr->data;
-    if(u->id == id){
-	Node *prev = ptr->prev;
-	Node *next = ptr->next;
-//	free(u->name);
-	free(ptr);
-	prev->next = next;
-	next->prev = prev;
-	list->size--;
+    node_free(list->alloc, ptr, sizeof(Node));
+    list->size--;
+}
+
+int list_delete(List *list, int id){
+    if(list->index){
+	IdSlot *slot = id_index_slot(list->index, id);
+	if(!slot->node) return -1;
+	Node *ptr = slot->node;
+	id_index_remove(list->index, slot);
+	list_unlink(list, ptr);
 	return 0;
     }
 
-    ptr = list->head;
-    /* check the between nodes */
-    while(ptr->next && ptr->next != list->head){
-	u = ptr->data;
+    Node *ptr = list->head;
+    for(size_t i = 0; i < list->size; ++i, ptr = ptr->next){
+	User *u = ptr->data;
 	if(u->id == id){
-	    Node *prev = ptr->prev;
-	    Node *next = ptr->next;
-//	    free(u->name);
-	    free(ptr);
-	    prev->next = next;
-	    next->prev = prev;
-	    list->size--;
+	    list_unlink(list, ptr);
 	    return 0;
 	}
-	ptr = ptr->next;
     }
     return -1;
 }
+
+static int list_cmp_id(const Node *a, const Node *b){
+    int x = ((User *) a->data)->id, y = ((User *) b->data)->id;
+    return (x > y) - (x < y);
+}
+
+/*
+ * the sort works on the next links only, with the circle cut open behind
+ * the tail; list_sort_close puts prev and the circle back in one pass
+ */
+static Node *list_sort_open(List *list){
+    Node *head = list->head;
+    head->prev->next = NULL;
+    return head;
+}
+
+static void list_sort_close(List *list, Node *head){
+    Node *prev = head;
+    for(Node *p = head->next; p; prev = p, p = p->next)
+	p->prev = prev;
+    prev->next = head;
+    head->prev = prev;
+    list->head = head;
+}
+
+/* see LIST_SORT_DEFINE in list_sort.h; the id index keeps pointing at the same nodes */
+int list_sort(List *list, list_cmp_fn cmp){
+    if(!list->head) return 0;
+    list_sort_close(list, list_sort_chain(list_sort_open(list), cmp));
+    return 0;
+}
+
+int list_sort_parallel(List *list, list_cmp_fn cmp, unsigned int nthreads){
+    if(!list->head) return 0;
+    list_sort_close(list, list_sort_chain_parallel(list_sort_open(list), list->size, cmp, nthreads));
+    return 0;
+}
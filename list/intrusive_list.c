@@ -0,0 +1,73 @@
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    "list.h"
+
+/* link, record and name share one allocation: the name sits right after the struct */
+typedef struct user {
+    ListHead link;
+    int id;
+    char name[];
+} User;
+
+User *user_create(const char *name, int id);
+void user_destroy(User *u);
+int user_delete(ListHead *users, int id);
+void user_print(ListHead *users);
+
+int main(){
+    LIST_HEAD(users);
+
+    list_add_tail(&user_create("yik ming", 81)->link, &users);
+    list_add_tail(&user_create("sing lek", 11)->link, &users);
+    list_add(&user_create("Yc", 12)->link, &users);
+    list_add(&user_create("Jason", 45)->link, &users);
+
+    user_delete(&users, 12);
+    user_delete(&users, 11);
+
+    user_print(&users);
+
+    User *u, *n;
+    list_for_each_entry_safe(u, n, &users, link){
+	list_del(&u->link);
+	user_destroy(u);
+    }
+    return 0;
+}
+
+User *user_create(const char *name, int id){
+    size_t name_len = strlen(name);
+    User *u = malloc(sizeof(User) + name_len + 1);
+    if(!u){
+	perror("malloc failed");
+	exit(EXIT_FAILURE);
+    }
+
+    INIT_LIST_HEAD(&u->link);
+    u->id = id;
+    memcpy(u->name, name, name_len + 1);
+    return u;
+}
+
+void user_destroy(User *u){
+    free(u);
+}
+
+int user_delete(ListHead *users, int id){
+    User *u, *n;
+    list_for_each_entry_safe(u, n, users, link){
+	if(u->id == id){
+	    list_del(&u->link);
+	    user_destroy(u);
+	    return 0;
+	}
+    }
+    return -1;
+}
+
+void user_print(ListHead *users){
+    User *u;
+    list_for_each_entry(u, users, link)
+	printf("%s's id is %d\n", u->name, u->id);
+}
@@ -2,10 +2,23 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "list_sort.h"
 #define BUF_SIZE 1024
 
+#define TG_INDEX_DFT_CAPACITY 1024u   /* trigram slots, power of 2 */
+#define TG_INDEX_LOAD_FACTOR 0.75
+#define TG_COMPACT_MIN 1024u          /* dead ids tolerated before postings are rebuilt */
+
+#define ULIST_NODE_CAP 8         /* names per unrolled node */
+#define ULIST_NAME_LEN 16        /* same bound as the names main reads */
+
+
 typedef struct user {
     char *name;
+    uint32_t id;   /* trigram index id, only meaningful while the index is on */
 } User;
 
 typedef struct node Node;
@@ -14,16 +27,82 @@ struct node {
     Node *next;   
 };
 
+/**
+ * unrolled list: every node keeps up to ULIST_NODE_CAP names inline, so a scan
+ * reads count and names from one contiguous block instead of chasing
+ * Node -> User -> name for each element.
+ * every node but the last is kept at least half full: a full node splits in two
+ * halves on insert, a node under half full borrows from or merges with its next.
+ */
+typedef struct unode UNode;
+struct unode {
+    UNode *next;
+    unsigned int count;
+    char names[ULIST_NODE_CAP][ULIST_NAME_LEN];
+};
+
+/**
+ * trigram inverted index for node_find: every 3-byte substring of a name maps
+ * to the posting list of node ids whose name contains it. ids only grow, so a
+ * posting list is a sorted run stored as varint deltas and appending is O(1).
+ * deleting or renaming a node retires its id (nodes[id] = NULL) instead of
+ * rewriting postings; once retired ids outnumber live ones, postings are rebuilt.
+ * a query intersects the postings of the pattern's trigrams and runs strstr
+ * only on the survivors.
+ */
+typedef struct posting {
+    uint32_t key;        /* trigram, 0 marks a free slot since names hold no NUL */
+    uint32_t count;
+    uint32_t last;       /* last id appended, the next delta is taken from it */
+    size_t len;
+    size_t cap;
+    uint8_t *buf;
+} Posting;
+
+typedef struct tg_index {
+    Posting *slots;
+    size_t capacity;
+    size_t size;
+    Node **nodes;        /* id -> node, NULL once retired */
+    size_t nnodes;
+    size_t nodes_cap;
+    size_t dead;
+} TgIndex;
+
+static TgIndex *tg_index;   /* NULL unless node_index_enable */
+
+typedef int (*node_cmp_fn)(const Node *a, const Node *b);
+
+LIST_SORT_DEFINE(node, Node, next)
+
 void usage();
+int node_index_enable(Node *curr);
+void node_index_disable();
+static int tg_index_add(Node *node);
+static void tg_index_retire(Node *node);
+static int tg_index_find(char *pattern);
 Node *node_insert_front(Node *curr, char *name);
 Node *node_insert_tail(Node *curr, char *name);
 Node *node_delete(Node *curr, char *name);
 Node *node_update(Node *curr, char *name, char *new);
 Node *node_find(Node *curr, char *pattern);
 void node_print(Node *curr);
-
-int main(){
+static int node_cmp_name(const Node *a, const Node *b);
+Node *node_sort(Node *curr, node_cmp_fn cmp);
+Node *node_sort_parallel(Node *curr, node_cmp_fn cmp, unsigned int nthreads);
+UNode *unode_insert_front(UNode *head, char *name);
+UNode *unode_insert_tail(UNode *head, char *name);
+UNode *unode_delete(UNode *head, char *name);
+UNode *unode_update(UNode *head, char *name, char *new);
+UNode *unode_find(UNode *head, char *pattern);
+void unode_print(UNode *head);
+
+int main(int argc, char *argv[]){
     Node *curr = NULL;
+    UNode *head = NULL;
+    int unrolled = argc > 1 && !strcmp(argv[1], "-u");
+    if(argc > 1 && !strcmp(argv[1], "-t"))
+	node_index_enable(curr);
     char buf[BUF_SIZE];
     char cmd;
     char name[16];
@@ -52,27 +131,50 @@ int main(){
 
 	switch(cmd){
 	    case 'i':
-	      curr = node_insert_front(curr, name);
+	      if(unrolled)
+		  head = unode_insert_front(head, name);
+	      else
+		  curr = node_insert_front(curr, name);
 	      break;
 
 	    case 't':
-	      curr = node_insert_tail(curr, name);
+	      if(unrolled)
+		  head = unode_insert_tail(head, name);
+	      else
+		  curr = node_insert_tail(curr, name);
 	      break;
 
 	    case 'd':
-	      curr = node_delete(curr,name);
+	      if(unrolled)
+		  head = unode_delete(head, name);
+	      else
+		  curr = node_delete(curr,name);
 	      break;
 
 	    case 'u':
-	      curr = node_update(curr, name, new);
+	      if(unrolled)
+		  head = unode_update(head, name, new);
+	      else
+		  curr = node_update(curr, name, new);
 	      break;
 
 	    case 'f':
-	      curr = node_find(curr, name); 
+	      if(unrolled)
+		  head = unode_find(head, name);
+	      else
+		  curr = node_find(curr, name); 
 	      break;
 
 	    case 'p':
-	      node_print(curr);
+	      if(unrolled)
+		  unode_print(head);
+	      else
+		  node_print(curr);
+	      break;
+
+	    case 's':
+	      if(!unrolled)
+		  curr = node_sort_parallel(curr, node_cmp_name, sysconf(_SC_NPROCESSORS_ONLN));
 	      break;
 
 	    case 'h':
@@ -84,11 +186,13 @@ int main(){
 	      break;
 	}
     }
+    node_index_disable();
 }
 
 void usage(){
-   printf("The format is 'cmd: name new', new[OPTIONAL](for updating current node)\n\n"); 
-   printf("cmd: 'i'(insert node at front)\t't'(insert node at tail)\t'd'(delete node)\t'f'(find all the node having the pattern)\t'p'(print all the node info)\t'h'(usage)\n");
+   printf("The format is 'cmd: name new', new[OPTIONAL](for updating current node)\n"); 
+   printf("Run with -u to keep the names in an unrolled list, -t to index them by trigram\n\n"); 
+   printf("cmd: 'i'(insert node at front)\t't'(insert node at tail)\t'd'(delete node)\t'f'(find all the node having the pattern)\t'p'(print all the node info)\t's'(sort by name)\t'h'(usage)\n");
 }
 Node *node_insert_front(Node *curr, char *name){
     size_t name_len = strlen(name);
@@ -100,6 +204,7 @@ Node *node_insert_front(Node *curr, char *name){
 	
 	new->data = user;
 	new->next = NULL;
+	tg_index_add(new);
 	return new;
     } else if(isalpha(*name)){
 	Node *new = malloc(sizeof(Node));
@@ -112,6 +217,7 @@ Node *node_insert_front(Node *curr, char *name){
 	prev = curr;
 	new->data = user;
 	new->next = prev;
+	tg_index_add(new);
 	return new;
     }
     return curr;
@@ -127,6 +233,7 @@ Node *node_insert_tail(Node *curr, char *name){
 	
 	new->data = user;
 	new->next = NULL;
+	tg_index_add(new);
 	return new;
     } else if(isalpha(*name)){
 	Node *new = malloc(sizeof(Node));
@@ -138,6 +245,7 @@ Node *node_insert_tail(Node *curr, char *name){
 
 	new->data = user;
 	new->next = NULL;
+	tg_index_add(new);
 
 	prev = curr;
 	while(prev->next)
@@ -154,6 +262,7 @@ Node *node_delete(Node *curr, char *name){
 
     /* case of romove the first node */
     if(!strcmp(user->name, name)){
+	tg_index_retire(curr);
 	p = curr->next;
 	return p;
     } 
@@ -164,6 +273,7 @@ Node *node_delete(Node *curr, char *name){
     while(p){
 	user = p->data;
 	if(!strcmp(user->name, name)){
+	    tg_index_retire(p);
 	    prev->next = p->next;
 	    free(user->name);
 	    free(p);
@@ -180,7 +290,14 @@ Node *node_update(Node *curr, char *name, char *new){
     while(p){
 	User *user = p->data;
 	if(!strcmp(user->name, name)){
+	    char *tmp = realloc(user->name, strlen(new) + 1);
+	    if(!tmp)
+		return curr;
+	    user->name = tmp;
+	    /* the old trigrams go with the old id */
+	    tg_index_retire(p);
 	    strcpy(user->name, new);
+	    tg_index_add(p);
 	    return curr;
 	}
 	p = p->next;
@@ -189,6 +306,9 @@ Node *node_update(Node *curr, char *name, char *new){
 }
 
 Node *node_find(Node *curr, char *pattern){
+    if(tg_index_find(pattern) == 0)
+	return curr;
+
     Node *p = curr;
     while(p){
 	User *user = p->data;
@@ -208,3 +328,395 @@ void node_print(Node *curr){
 	curr = curr->next;
     }
 }
+
+static int node_cmp_name(const Node *a, const Node *b){
+    return strcmp(((User *) a->data)->name, ((User *) b->data)->name);
+}
+
+/* see LIST_SORT_DEFINE in list_sort.h */
+Node *node_sort(Node *curr, node_cmp_fn cmp){
+    return node_sort_chain(curr, cmp);
+}
+
+Node *node_sort_parallel(Node *curr, node_cmp_fn cmp, unsigned int nthreads){
+    size_t len = 0;
+    for(Node *p = curr; p; p = p->next)
+	++len;
+    return node_sort_chain_parallel(curr, len, cmp, nthreads);
+}
+
+static uint32_t tg_key(const char *s){
+    return ((uint32_t) (unsigned char) s[0] << 16) | ((uint32_t) (unsigned char) s[1] << 8) | (unsigned char) s[2];
+}
+
+static size_t tg_hash(uint32_t key, size_t capacity){
+    return (size_t) (((uint64_t) key * 0x9e3779b97f4a7c15ull) >> 32) & (capacity - 1);
+}
+
+/* slot of key, or the free slot where it would go */
+static Posting *tg_slot(Posting *slots, size_t capacity, uint32_t key){
+    size_t i = tg_hash(key, capacity);
+    while(slots[i].key && slots[i].key != key)
+	i = (i + 1) & (capacity - 1);
+    return &slots[i];
+}
+
+static int tg_rehash(TgIndex *index){
+    size_t new_cap = index->capacity << 1u;
+    Posting *slots = calloc(new_cap, sizeof(Posting));
+    if(!slots) return -1;
+
+    for(size_t i = 0; i < index->capacity; ++i)
+	if(index->slots[i].key)
+	    *tg_slot(slots, new_cap, index->slots[i].key) = index->slots[i];
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = new_cap;
+    return 0;
+}
+
+static int tg_posting_append(Posting *post, uint32_t id){
+    if(post->count && post->last == id)   /* trigram repeats inside one name */
+	return 0;
+    if(post->len + 5 > post->cap){
+	size_t new_cap = post->cap ? post->cap << 1u : 8;
+	uint8_t *tmp = realloc(post->buf, new_cap);
+	if(!tmp) return -1;
+	post->buf = tmp;
+	post->cap = new_cap;
+    }
+
+    uint32_t delta = id - post->last;
+    while(delta >= 0x80){
+	post->buf[post->len++] = (uint8_t) (delta | 0x80);
+	delta >>= 7;
+    }
+    post->buf[post->len++] = (uint8_t) delta;
+    post->last = id;
+    post->count++;
+    return 0;
+}
+
+static const uint8_t *tg_varint(const uint8_t *p, uint32_t *delta){
+    uint32_t v = 0;
+    for(unsigned int shift = 0; ; shift += 7){
+	v |= (uint32_t) (*p & 0x7f) << shift;
+	if(!(*p++ & 0x80))
+	    break;
+    }
+    *delta = v;
+    return p;
+}
+
+/* -1 if a posting could not take id, the index then misses the name */
+static int tg_post_name(TgIndex *index, const char *name, uint32_t id){
+    size_t len = strlen(name);
+    for(size_t i = 0; i + 3 <= len; ++i){
+	uint32_t key = tg_key(name + i);
+	Posting *post = tg_slot(index->slots, index->capacity, key);
+	if(!post->key){
+	    if((double) (index->size + 1) / (double) index->capacity >= TG_INDEX_LOAD_FACTOR){
+		if(tg_rehash(index) < 0) return -1;
+		post = tg_slot(index->slots, index->capacity, key);
+	    }
+	    post->key = key;
+	    index->size++;
+	}
+	if(tg_posting_append(post, id) < 0)
+	    return -1;
+    }
+    return 0;
+}
+
+/* drop retired ids: hand out ids again densely and rebuild every posting */
+static int tg_compact(TgIndex *index){
+    size_t live = 0;
+
+    for(size_t i = 0; i < index->capacity; ++i){
+	index->slots[i].len = 0;
+	index->slots[i].count = 0;
+	index->slots[i].last = 0;
+    }
+    for(size_t id = 0; id < index->nnodes; ++id){
+	Node *node = index->nodes[id];
+	if(!node) continue;
+	User *user = node->data;
+	user->id = live;
+	index->nodes[live++] = node;
+	if(tg_post_name(index, user->name, user->id) < 0)
+	    return -1;
+    }
+    index->nnodes = live;
+    index->dead = 0;
+    return 0;
+}
+
+/**
+ * a name missing from the index would make tg_index_find answer wrongly, so
+ * when one cannot be added the whole index is dropped and node_find scans
+ */
+static int tg_index_add(Node *node){
+    TgIndex *index = tg_index;
+    if(!index) return 0;
+
+    if(index->nnodes == index->nodes_cap){
+	size_t new_cap = index->nodes_cap ? index->nodes_cap << 1u : 64;
+	Node **tmp = realloc(index->nodes, sizeof(Node *) * new_cap);
+	if(!tmp) goto fail;
+	index->nodes = tmp;
+	index->nodes_cap = new_cap;
+    }
+
+    User *user = node->data;
+    user->id = index->nnodes;
+    index->nodes[index->nnodes++] = node;
+    if(tg_post_name(index, user->name, user->id) < 0)
+	goto fail;
+    return 0;
+
+fail:
+    node_index_disable();
+    return -1;
+}
+
+static void tg_index_retire(Node *node){
+    TgIndex *index = tg_index;
+    if(!index) return;
+
+    User *user = node->data;
+    index->nodes[user->id] = NULL;
+    if(++index->dead >= TG_COMPACT_MIN && index->dead > index->nnodes - index->dead &&
+	    tg_compact(index) < 0)
+	node_index_disable();   /* postings are half rebuilt, see tg_index_add */
+}
+
+/* return -1 when the index cannot answer and the caller has to scan */
+static int tg_index_find(char *pattern){
+    TgIndex *index = tg_index;
+    size_t len = strlen(pattern);
+    if(!index || len < 3)
+	return -1;
+
+    size_t npost = len - 2;
+    Posting *posts[npost];
+    for(size_t i = 0; i < npost; ++i){
+	Posting *post = tg_slot(index->slots, index->capacity, tg_key(pattern + i));
+	if(!post->key || !post->count)
+	    return 0;   /* some trigram occurs nowhere */
+	posts[i] = post;
+    }
+
+    /* shortest posting first, it bounds the candidates */
+    for(size_t i = 1; i < npost; ++i){
+	Posting *post = posts[i];
+	size_t j = i;
+	for(; j > 0 && posts[j - 1]->count > post->count; --j)
+	    posts[j] = posts[j - 1];
+	posts[j] = post;
+    }
+
+    uint32_t *cand = malloc(sizeof(uint32_t) * posts[0]->count);
+    if(!cand)
+	return -1;
+    size_t ncand = 0;
+    const uint8_t *p = posts[0]->buf, *end = posts[0]->buf + posts[0]->len;
+    for(uint32_t id = 0, delta; p < end; ){
+	p = tg_varint(p, &delta);
+	id += delta;
+	cand[ncand++] = id;
+    }
+
+    /* merge every other posting against the survivors */
+    for(size_t i = 1; i < npost && ncand; ++i){
+	size_t kept = 0, c = 0;
+	const uint8_t *q = posts[i]->buf, *qend = posts[i]->buf + posts[i]->len;
+	uint32_t id = 0, delta;
+	while(q < qend && c < ncand){
+	    q = tg_varint(q, &delta);
+	    id += delta;
+	    while(c < ncand && cand[c] < id)
+		c++;
+	    if(c < ncand && cand[c] == id)
+		cand[kept++] = cand[c++];
+	}
+	ncand = kept;
+    }
+
+    for(size_t i = 0; i < ncand; ++i){
+	Node *node = index->nodes[cand[i]];
+	if(!node) continue;
+	User *user = node->data;
+	if(strstr(user->name, pattern))
+	    printf("Found: %s having pattern '%s'\n", user->name, pattern);
+    }
+    free(cand);
+    return 0;
+}
+
+/* build the index over the current list, from now on insert/delete/update keep it in sync */
+int node_index_enable(Node *curr){
+    if(tg_index) return 0;
+
+    TgIndex *index = calloc(1, sizeof(TgIndex));
+    if(!index) return -1;
+    index->capacity = TG_INDEX_DFT_CAPACITY;
+    if(!(index->slots = calloc(index->capacity, sizeof(Posting)))){
+	free(index);
+	return -1;
+    }
+
+    tg_index = index;
+    for(Node *p = curr; p; p = p->next)
+	if(tg_index_add(p) < 0)
+	    return -1;
+    return 0;
+}
+
+void node_index_disable(){
+    TgIndex *index = tg_index;
+    if(!index) return;
+
+    for(size_t i = 0; i < index->capacity; ++i)
+	free(index->slots[i].buf);
+    free(index->slots);
+    free(index->nodes);
+    free(index);
+    tg_index = NULL;
+}
+
+/* split a full node: its upper half moves to a new node right after it */
+static UNode *unode_split(UNode *node){
+    UNode *new = malloc(sizeof(UNode));
+    if(!new)
+	return NULL;
+    unsigned int half = ULIST_NODE_CAP / 2;
+
+    memcpy(new->names, node->names[half], (ULIST_NODE_CAP - half) * ULIST_NAME_LEN);
+    new->count = ULIST_NODE_CAP - half;
+    new->next = node->next;
+    node->count = half;
+    node->next = new;
+    return new;
+}
+
+/* put name at index pos of node, splitting first if node is full */
+static int unode_insert_at(UNode *node, unsigned int pos, char *name){
+    if(node->count == ULIST_NODE_CAP){
+	UNode *upper = unode_split(node);
+	if(!upper)
+	    return -1;
+	if(pos > node->count){
+	    pos -= node->count;
+	    node = upper;
+	}
+    }
+    // invariant: node has a free slot
+    memmove(node->names[pos + 1], node->names[pos], (node->count - pos) * ULIST_NAME_LEN);
+    strcpy(node->names[pos], name);
+    node->count++;
+    return 0;
+}
+
+static int unode_name_ok(char *name){
+    return isalpha(*name) && strlen(name) < ULIST_NAME_LEN;
+}
+
+static UNode *unode_new(char *name){
+    UNode *new = malloc(sizeof(UNode));
+    if(!new)
+	return NULL;
+    strcpy(new->names[0], name);
+    new->count = 1;
+    new->next = NULL;
+    return new;
+}
+
+UNode *unode_insert_front(UNode *head, char *name){
+    if(!unode_name_ok(name))
+	return head;
+    if(!head)
+	return unode_new(name);
+    unode_insert_at(head, 0, name);
+    return head;
+}
+
+UNode *unode_insert_tail(UNode *head, char *name){
+    if(!unode_name_ok(name))
+	return head;
+    if(!head)
+	return unode_new(name);
+
+    UNode *tail = head;
+    while(tail->next)
+	tail = tail->next;
+    unode_insert_at(tail, tail->count, name);
+    return head;
+}
+
+/* node fell under half full: top it up from next, or fold next into it */
+static void unode_rebalance(UNode *node){
+    UNode *next = node->next;
+    if(!next || node->count >= ULIST_NODE_CAP / 2)
+	return;
+
+    if(node->count + next->count <= ULIST_NODE_CAP){
+	memcpy(node->names[node->count], next->names, next->count * ULIST_NAME_LEN);
+	node->count += next->count;
+	node->next = next->next;
+	free(next);
+    } else {
+	/* next holds more than half after lending one */
+	strcpy(node->names[node->count++], next->names[0]);
+	memmove(next->names[0], next->names[1], --next->count * ULIST_NAME_LEN);
+    }
+}
+
+UNode *unode_delete(UNode *head, char *name){
+    UNode *prev = NULL;
+
+    for(UNode *p = head; p; prev = p, p = p->next){
+	for(unsigned int i = 0; i < p->count; ++i){
+	    if(strcmp(p->names[i], name))
+		continue;
+
+	    memmove(p->names[i], p->names[i + 1], (p->count - i - 1) * ULIST_NAME_LEN);
+	    p->count--;
+	    if(p->count == 0){    /* only a last node can run empty */
+		if(prev)
+		    prev->next = p->next;
+		else
+		    head = p->next;
+		free(p);
+	    } else
+		unode_rebalance(p);
+	    return head;
+	}
+    }
+    return head;
+}
+
+UNode *unode_update(UNode *head, char *name, char *new){
+    if(strlen(new) >= ULIST_NAME_LEN)
+	return head;
+    for(UNode *p = head; p; p = p->next)
+	for(unsigned int i = 0; i < p->count; ++i)
+	    if(!strcmp(p->names[i], name)){
+		strcpy(p->names[i], new);
+		return head;
+	    }
+    return head;
+}
+
+UNode *unode_find(UNode *head, char *pattern){
+    for(UNode *p = head; p; p = p->next)
+	for(unsigned int i = 0; i < p->count; ++i)
+	    if(strstr(p->names[i], pattern))
+		printf("Found: %s having pattern '%s'\n", p->names[i], pattern);
+    return head;
+}
+
+void unode_print(UNode *head){
+    for(UNode *p = head; p; p = p->next)
+	for(unsigned int i = 0; i < p->count; ++i)
+	    printf("%s\n", p->names[i]);
+}
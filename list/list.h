@@ -0,0 +1,80 @@
+#ifndef	    LIST_H
+#define	    LIST_H
+
+#include    <stddef.h>
+
+/**
+ * Intrusive circular doubly linked list in the style of the Linux kernel.
+ * The links live inside the user's struct, so one allocation holds both and
+ * list_entry gets from a link back to its record with pointer arithmetic
+ * instead of a load through void *data. An empty list is a head pointing to itself.
+ */
+typedef struct list_head {
+    struct list_head *next;
+    struct list_head *prev;
+} ListHead;
+
+#define	    container_of(ptr, type, member) \
+    ((type *) ((char *) (ptr) - offsetof(type, member)))
+
+#define	    list_entry(ptr, type, member) container_of(ptr, type, member)
+
+#define	    list_first_entry(head, type, member) list_entry((head)->next, type, member)
+
+#define	    LIST_HEAD_INIT(name) { &(name), &(name) }
+
+#define	    LIST_HEAD(name) ListHead name = LIST_HEAD_INIT(name)
+
+#define	    list_for_each(pos, head) \
+    for(pos = (head)->next; pos != (head); pos = pos->next)
+
+#define	    list_for_each_entry(pos, head, member) \
+    for(pos = list_entry((head)->next, typeof(*pos), member); \
+	    &pos->member != (head); \
+	    pos = list_entry(pos->member.next, typeof(*pos), member))
+
+/* n caches the next entry, so pos may be deleted inside the loop */
+#define	    list_for_each_entry_safe(pos, n, head, member) \
+    for(pos = list_entry((head)->next, typeof(*pos), member), \
+	    n = list_entry(pos->member.next, typeof(*pos), member); \
+	    &pos->member != (head); \
+	    pos = n, n = list_entry(n->member.next, typeof(*n), member))
+
+static inline void INIT_LIST_HEAD(ListHead *head){
+    head->next = head;
+    head->prev = head;
+}
+
+static inline void __list_add(ListHead *new, ListHead *prev, ListHead *next){
+    next->prev = new;
+    new->next = next;
+    new->prev = prev;
+    prev->next = new;
+}
+
+/* insert right after head, a stack push */
+static inline void list_add(ListHead *new, ListHead *head){
+    __list_add(new, head, head->next);
+}
+
+/* insert right before head, a queue push */
+static inline void list_add_tail(ListHead *new, ListHead *head){
+    __list_add(new, head->prev, head);
+}
+
+/* unlink entry, it is left self-linked so a second list_del is harmless */
+static inline void list_del(ListHead *entry){
+    entry->next->prev = entry->prev;
+    entry->prev->next = entry->next;
+    INIT_LIST_HEAD(entry);
+}
+
+static inline int list_empty(const ListHead *head){
+    return head->next == head;
+}
+
+static inline int list_is_singular(const ListHead *head){
+    return !list_empty(head) && head->next == head->prev;
+}
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef	    LIST_SORT_H
+#define	    LIST_SORT_H
+
+#include    <stddef.h>
+#include    <pthread.h>
+
+#define	    LIST_SORT_PAR_MIN		8192u	/* shorter lists are not worth a thread */
+#define	    LIST_SORT_MAX_THREADS	16u
+
+/**
+ * Merge sort for a NULL-terminated chain of nodes linked through one member.
+ * LIST_SORT_DEFINE(name, type, next) defines, for cmp of type
+ * int (*)(const type *, const type *) returning <0, 0, >0:
+ *
+ *   type *name_sort_chain(type *head, cmp)
+ *	bottom-up natural merge sort: every pass walks the chain once, cutting
+ *	it into the runs that are already sorted and merging them pairwise, so
+ *	the number of runs at least halves per pass and a sorted chain costs one
+ *	pass. Nodes are relinked in place, nothing is allocated, stable.
+ *
+ *   type *name_sort_chain_parallel(type *head, size_t len, cmp, unsigned int nthreads)
+ *	cut the chain of len nodes into about nthreads chunks of equal length,
+ *	each cut moved forward to the end of the run it lands in so no run is
+ *	split, sort the chunks concurrently, then merge neighbouring chunks
+ *	pairwise, one round of concurrent merges per level. Falls back to
+ *	name_sort_chain below LIST_SORT_PAR_MIN nodes or with fewer than 2 threads.
+ *
+ * Only the next links are touched; a doubly linked list fixes prev afterwards.
+ */
+#define	    LIST_SORT_DEFINE(name, type, next)						\
+											\
+/* one chunk of name##_sort_chain_parallel: sort head, or merge head with other */	\
+struct name##_sort_job {								\
+    type *head;										\
+    type *other;									\
+    int (*cmp)(const type *, const type *);						\
+};											\
+											\
+/* last node of the non-descending run starting at p */				\
+static inline type *name##_run_end(type *p, int (*cmp)(const type *, const type *)){	\
+    while(p->next && cmp(p, p->next) <= 0)						\
+	p = p->next;									\
+    return p;										\
+}											\
+											\
+/* stable merge of two NULL-terminated runs, a's nodes win ties; *tail gets the last node */ \
+static inline type *name##_merge(type *a, type *a_end, type *b, type *b_end,		\
+	int (*cmp)(const type *, const type *), type **tail){				\
+    type *head, **link = &head;								\
+    while(a && b){									\
+	if(cmp(b, a) < 0){								\
+	    *link = b;									\
+	    link = &b->next;								\
+	    b = b->next;								\
+	} else {									\
+	    *link = a;									\
+	    link = &a->next;								\
+	    a = a->next;								\
+	}										\
+    }											\
+    *link = a ? a : b;									\
+    if(tail)										\
+	*tail = a ? a_end : b_end;							\
+    return head;									\
+}											\
+											\
+static inline type *name##_sort_chain(type *head, int (*cmp)(const type *, const type *)){ \
+    size_t runs;									\
+											\
+    do {										\
+	type *sorted = NULL, **link = &sorted;						\
+	type *p = head;									\
+	runs = 0;									\
+	while(p){									\
+	    type *a = p, *a_end = name##_run_end(a, cmp);				\
+	    type *b = a_end->next;							\
+	    ++runs;									\
+	    if(!b){									\
+		*link = a;								\
+		break;									\
+	    }										\
+											\
+	    type *b_end = name##_run_end(b, cmp);					\
+	    ++runs;									\
+	    p = b_end->next;								\
+	    a_end->next = b_end->next = NULL;						\
+											\
+	    type *tail;									\
+	    *link = name##_merge(a, a_end, b, b_end, cmp, &tail);			\
+	    link = &tail->next;								\
+	}										\
+	head = sorted;									\
+    } while(runs > 2);									\
+    return head;									\
+}											\
+											\
+static inline void *name##_sort_worker(void *arg){					\
+    struct name##_sort_job *job = arg;							\
+    if(job->other)									\
+	job->head = name##_merge(job->head, NULL, job->other, NULL, job->cmp, NULL);	\
+    else										\
+	job->head = name##_sort_chain(job->head, job->cmp);				\
+    return NULL;									\
+}											\
+											\
+/* run jobs[0..n) on their own threads, jobs[0] on the caller's */			\
+static inline void name##_sort_run(struct name##_sort_job *jobs, size_t n){		\
+    pthread_t tids[LIST_SORT_MAX_THREADS];						\
+    int started[LIST_SORT_MAX_THREADS];							\
+											\
+    for(size_t i = 1; i < n; ++i){							\
+	started[i] = !pthread_create(&tids[i], NULL, name##_sort_worker, &jobs[i]);	\
+	if(!started[i])									\
+	    name##_sort_worker(&jobs[i]);						\
+    }											\
+    name##_sort_worker(&jobs[0]);							\
+    for(size_t i = 1; i < n; ++i)							\
+	if(started[i])									\
+	    pthread_join(tids[i], NULL);						\
+}											\
+											\
+static inline type *name##_sort_chain_parallel(type *head, size_t len,		\
+	int (*cmp)(const type *, const type *), unsigned int nthreads){			\
+    struct name##_sort_job jobs[LIST_SORT_MAX_THREADS];					\
+    size_t chunks = 0;									\
+											\
+    if(nthreads > LIST_SORT_MAX_THREADS)						\
+	nthreads = LIST_SORT_MAX_THREADS;						\
+    if(nthreads < 2 || len < LIST_SORT_PAR_MIN)						\
+	return name##_sort_chain(head, cmp);						\
+											\
+    size_t chunk_len = len / nthreads;							\
+    type *p = head;									\
+    while(p){										\
+	type *end = p;									\
+	jobs[chunks++] = (struct name##_sort_job){ .head = p, .other = NULL, .cmp = cmp }; \
+	if(chunks < nthreads){								\
+	    for(size_t i = 1; i < chunk_len && end->next; ++i)				\
+		end = end->next;							\
+	    end = name##_run_end(end, cmp);						\
+	} else {									\
+	    while(end->next)								\
+		end = end->next;							\
+	}										\
+	p = end->next;									\
+	end->next = NULL;								\
+    }											\
+    name##_sort_run(jobs, chunks);							\
+											\
+    while(chunks > 1){									\
+	size_t pairs = chunks / 2;							\
+	for(size_t i = 0; i < pairs; ++i){						\
+	    jobs[i].head = jobs[2 * i].head;						\
+	    jobs[i].other = jobs[2 * i + 1].head;					\
+	}										\
+	name##_sort_run(jobs, pairs);							\
+	/* an odd chunk out waits for the next round */					\
+	if(chunks & 1)									\
+	    jobs[pairs++] = (struct name##_sort_job){ .head = jobs[chunks - 1].head, .other = NULL, .cmp = cmp }; \
+	chunks = pairs;									\
+    }											\
+    return jobs[0].head;								\
+}
+
+#endif
@@ -0,0 +1,143 @@
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    "block_deque.h"
+
+/* exactly the blocks covering slots [begin, begin + size) are allocated, the rest of map is NULL */
+
+static int *deque_block_get(Deque *dq){
+    int *block = dq->spare;
+    if(block){
+	dq->spare = NULL;
+	return block;
+    }
+    return malloc(sizeof(int) * DEQUE_BLOCK_CAP);
+}
+
+static void deque_block_put(Deque *dq, size_t b){
+    if(!dq->spare)
+	dq->spare = dq->map[b];
+    else
+	free(dq->map[b]);
+    dq->map[b] = NULL;
+}
+
+/* an end ran into the edge of map: re-centre the used block pointers, doubling map if it is over half used */
+static int deque_map_grow(Deque *dq){
+    size_t first = dq->begin >> DEQUE_BLOCK_SHIFT;
+    size_t used = dq->size ? ((dq->begin + dq->size - 1) >> DEQUE_BLOCK_SHIFT) - first + 1 : 0;
+    size_t new_capacity = dq->map_capacity;
+
+    if((used + 2) * 2 > new_capacity)
+	new_capacity <<= 1u;
+
+    int **map = calloc(new_capacity, sizeof(int *));
+    if(!map) return ERR_MALLOC_FAILED;
+    // invariant: map is malloc successfully
+
+    size_t new_first = (new_capacity - used) / 2;
+    memcpy(map + new_first, dq->map + first, sizeof(int *) * used);
+    free(dq->map);
+    dq->map = map;
+    dq->map_capacity = new_capacity;
+    dq->begin = (new_first << DEQUE_BLOCK_SHIFT) + (dq->begin & DEQUE_BLOCK_MASK);
+    return 0;
+}
+
+/* empty deque starts in the middle block so both ends have room */
+static void deque_reset(Deque *dq){
+    dq->begin = (dq->map_capacity / 2) << DEQUE_BLOCK_SHIFT;
+}
+
+int deque_init(Deque *dq){
+    dq->map = calloc(DEQUE_MAP_DFT_CAPACITY, sizeof(int *));
+    if(!dq->map) return ERR_MALLOC_FAILED;
+    dq->map_capacity = DEQUE_MAP_DFT_CAPACITY;
+    dq->size = 0;
+    dq->spare = NULL;
+    deque_reset(dq);
+    return 0;
+}
+
+int deque_destruct(Deque *dq){
+    for(size_t b = 0; b < dq->map_capacity; ++b)
+	free(dq->map[b]);
+    free(dq->map);
+    free(dq->spare);
+    dq->map = NULL;
+    dq->spare = NULL;
+    dq->map_capacity = dq->size = dq->begin = 0;
+    return 0;
+}
+
+int deque_push_back(Deque *dq, int data){
+    if(dq->begin + dq->size == dq->map_capacity << DEQUE_BLOCK_SHIFT && deque_map_grow(dq) < 0)
+	return ERR_MALLOC_FAILED;
+
+    size_t k = dq->begin + dq->size;
+    size_t b = k >> DEQUE_BLOCK_SHIFT;
+    if(!dq->map[b] && !(dq->map[b] = deque_block_get(dq)))
+	return ERR_MALLOC_FAILED;
+    // invariant: slot k is backed by a block
+    dq->map[b][k & DEQUE_BLOCK_MASK] = data;
+    dq->size++;
+    return 0;
+}
+
+int deque_push_front(Deque *dq, int data){
+    if(dq->begin == 0 && deque_map_grow(dq) < 0)
+	return ERR_MALLOC_FAILED;
+
+    size_t k = dq->begin - 1;
+    size_t b = k >> DEQUE_BLOCK_SHIFT;
+    if(!dq->map[b] && !(dq->map[b] = deque_block_get(dq)))
+	return ERR_MALLOC_FAILED;
+    dq->map[b][k & DEQUE_BLOCK_MASK] = data;
+    dq->begin = k;
+    dq->size++;
+    return 0;
+}
+
+int deque_pop_back(Deque *dq, int *data){
+    if(deque_isempty(dq))
+	return ERR_DEQUE_EMPTY;
+
+    size_t k = dq->begin + --dq->size;
+    size_t b = k >> DEQUE_BLOCK_SHIFT;
+    *data = dq->map[b][k & DEQUE_BLOCK_MASK];
+    /* k was the first slot of its block, nothing is left in it */
+    if((k & DEQUE_BLOCK_MASK) == 0 || dq->size == 0)
+	deque_block_put(dq, b);
+    if(dq->size == 0)
+	deque_reset(dq);
+    return 0;
+}
+
+int deque_pop_front(Deque *dq, int *data){
+    if(deque_isempty(dq))
+	return ERR_DEQUE_EMPTY;
+
+    size_t k = dq->begin++;
+    size_t b = k >> DEQUE_BLOCK_SHIFT;
+    *data = dq->map[b][k & DEQUE_BLOCK_MASK];
+    dq->size--;
+    /* k was the last slot of its block, nothing is left in it */
+    if((k & DEQUE_BLOCK_MASK) == DEQUE_BLOCK_MASK || dq->size == 0)
+	deque_block_put(dq, b);
+    if(dq->size == 0)
+	deque_reset(dq);
+    return 0;
+}
+
+int deque_print(Deque *dq){
+    if(deque_isempty(dq)){
+	printf("The deque is empty!\n");
+	return 0;
+    }
+    //invariant: the deque has entities
+    printf("Deque: ");
+    for(size_t i = 0; i < dq->size; ++i)
+	printf("%d ", *deque_at(dq, i));
+    printf("\n");
+    return 0;
+}
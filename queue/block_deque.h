@@ -0,0 +1,59 @@
+#ifndef	    BLOCK_DEQUE_H
+#define	    BLOCK_DEQUE_H
+
+#include    <stddef.h>
+
+#define	    ERR_MALLOC_FAILED	-1
+#define	    ERR_DEQUE_EMPTY	-2
+
+#define	    DEQUE_BLOCK_SHIFT	9u
+#define	    DEQUE_BLOCK_CAP	(1u << DEQUE_BLOCK_SHIFT)	/* elements per block */
+#define	    DEQUE_BLOCK_MASK	(DEQUE_BLOCK_CAP - 1)
+#define	    DEQUE_MAP_DFT_CAPACITY	8u
+
+/**
+ * Block deque: elements live in fixed-size blocks, a central map holds the block
+ * pointers in order. Slot k of the deque (counted from map[0]) is
+ * map[k >> SHIFT][k & MASK], the front is slot begin. Growing at either end only
+ * adds a block or, rarely, re-centres the map of pointers, so an element never
+ * moves and a pointer from deque_at stays valid until that element is popped.
+ */
+typedef struct deque {
+    int **map;
+    size_t map_capacity;   /* block pointers in map */
+    size_t begin;          /* slot of the front element */
+    size_t size;
+    int *spare;            /* one emptied block kept so a boundary ping-pong does not hit malloc */
+} Deque;
+
+int deque_init(Deque *dq);
+
+int deque_destruct(Deque *dq);
+
+int deque_push_back(Deque *dq, int data);
+
+int deque_push_front(Deque *dq, int data);
+
+int deque_pop_back(Deque *dq, int *data);
+
+int deque_pop_front(Deque *dq, int *data);
+
+int deque_print(Deque *dq);
+
+static inline size_t deque_size(Deque *dq){
+    return dq->size;
+}
+
+static inline int deque_isempty(Deque *dq){
+    return (dq->size == 0);
+}
+
+/* random access, NULL if i is out of range */
+static inline int *deque_at(Deque *dq, size_t i){
+    if(i >= dq->size)
+	return NULL;
+    size_t k = dq->begin + i;
+    return &dq->map[k >> DEQUE_BLOCK_SHIFT][k & DEQUE_BLOCK_MASK];
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    "block_deque.h"
+
+int main(){
+    Deque dq;
+    int data;
+    if(deque_init(&dq) < 0){
+	perror("deque_init");
+	exit(EXIT_FAILURE);
+    }
+
+    deque_push_back(&dq, 3);
+    deque_push_back(&dq, 4);
+    deque_push_front(&dq, 2);
+    deque_push_front(&dq, 1);
+    deque_push_back(&dq, 5);
+    deque_print(&dq);
+
+    deque_pop_front(&dq, &data);
+    printf("front: %d\n", data);
+    deque_pop_back(&dq, &data);
+    printf("back: %d\n", data);
+    deque_print(&dq);
+
+    /* a pointer into the deque survives growth at both ends, blocks and map re-centring included */
+    int *mid = deque_at(&dq, 1);
+    printf("deque_at(1) = %d at %p\n", *mid, (void *) mid);
+    for(int i = 0; i < 10 * (int) DEQUE_BLOCK_CAP; ++i){
+	deque_push_front(&dq, -i);
+	deque_push_back(&dq, 100 + i);
+    }
+    printf("after %zu pushes, map of %zu blocks\n", deque_size(&dq) - 3, dq.map_capacity);
+    printf("deque_at(%zu) = %d at %p\n", 10 * (size_t) DEQUE_BLOCK_CAP + 1,
+	    *deque_at(&dq, 10 * DEQUE_BLOCK_CAP + 1), (void *) deque_at(&dq, 10 * DEQUE_BLOCK_CAP + 1));
+    printf("the old pointer still reads %d\n", *mid);
+
+    while(deque_size(&dq) > 3){
+	deque_pop_front(&dq, &data);
+	deque_pop_back(&dq, &data);
+    }
+    deque_print(&dq);
+
+    while(deque_pop_back(&dq, &data) == 0)
+	printf("back: %d\n", data);
+    deque_print(&dq);
+
+    deque_destruct(&dq);
+    exit(EXIT_SUCCESS);
+}
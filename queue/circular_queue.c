@@ -1,9 +1,16 @@
 #include    <stdio.h>
 #include    <string.h>
 #include    <stdlib.h>
+#include    <stdint.h>
+#include    <unistd.h>
+#include    <errno.h>
+#include    <poll.h>
+#include    <pthread.h>
+#include    <sys/eventfd.h>
 
 #define	    BUF_SIZE	0x0400 
 #define	    RBUF_DFT_CAPACITY	16u
+#define	    RBUF_DRAIN_BATCH	64u
 
 /* ERR STATUS CODE */
 #define	    ERR_MALLOC_FAILED	-1
@@ -14,8 +21,15 @@ typedef struct rbuf {
   size_t size;
   size_t head;
   size_t tail;
+  int efd;                   /* eventfd in notify mode, -1 otherwise */
+  pthread_mutex_t lock;      /* only taken in notify mode, producer and consumer are different threads */
 } Rbuf;
 
+typedef struct producer_arg {
+    Rbuf *rbuf;
+    int n;
+} ProducerArg;
+
 void usage();
 
 int rbuf_init(Rbuf *rbuf);
@@ -32,6 +46,12 @@ int rbuf_isfull(Rbuf *rbuf);
 
 int rbuf_isempty(Rbuf *rbuf);
 
+int rbuf_notify_enable(Rbuf *rbuf);
+
+size_t rbuf_drain(Rbuf *rbuf, int *out, size_t max);
+
+int rbuf_stream(Rbuf *rbuf, int n);
+
 int main(){
     Rbuf rbuf;
     rbuf_init(&rbuf);
@@ -58,6 +78,12 @@ int main(){
 	      rbuf_print(&rbuf);
 	      break;
 
+	    case 't':;
+	      int n = atoi(strrchr(buf, ' ') ? strrchr(buf, ' ') + 1 : "0");
+	      if(n <= 0 || rbuf_stream(&rbuf, n) < 0)
+		fprintf(stderr, "stream needs a positive count.\n");
+	      break;
+
 	    default:
 	      fprintf(stderr, "Unknown command. Please try again!\n");
 	      usage();
@@ -73,6 +99,7 @@ void usage(){
     printf("To push data: <push> <data>\n");
     printf("To pop data: <pop>\n");
     printf("To print all data: <print>\n");
+    printf("To stream data from a producer thread: <stream> <count>\n");
     return;
 }
 
@@ -83,20 +110,83 @@ int rbuf_init(Rbuf *rbuf){
    rbuf->size = 0;
    rbuf->head = 0;
    rbuf->tail = 0;
+   rbuf->efd = -1;
+   pthread_mutex_init(&rbuf->lock, NULL);
    return 0;
 }
 
 int rbuf_destruct(Rbuf *rbuf){
     free(rbuf->buf);
+    if(rbuf->efd >= 0)
+	close(rbuf->efd);
+    pthread_mutex_destroy(&rbuf->lock);
     return 0;
 }
 
+static void rbuf_lock(Rbuf *rbuf){
+    if(rbuf->efd >= 0)
+	pthread_mutex_lock(&rbuf->lock);
+}
+
+static void rbuf_unlock(Rbuf *rbuf){
+    if(rbuf->efd >= 0)
+	pthread_mutex_unlock(&rbuf->lock);
+}
+
+static void rbuf_signal(Rbuf *rbuf){
+    uint64_t one = 1;
+    /* EAGAIN means the counter is already non-zero, the consumer will wake anyway */
+    (void) !write(rbuf->efd, &one, sizeof(one));
+}
+
+/**
+ * notify mode: the returned eventfd becomes readable when the queue goes from
+ * empty to non-empty, so it can sit in an epoll set instead of polling rbuf_isempty.
+ * Must be called before the queue is shared.
+ */
+int rbuf_notify_enable(Rbuf *rbuf){
+    if(rbuf->efd >= 0) return rbuf->efd;
+    rbuf->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    /* values pushed before this will never make an empty to non-empty edge */
+    if(rbuf->efd >= 0 && !rbuf_isempty(rbuf))
+	rbuf_signal(rbuf);
+    return rbuf->efd;
+}
+
+/* pop up to max values into out on wakeup, return how many */
+size_t rbuf_drain(Rbuf *rbuf, int *out, size_t max){
+    size_t n = 0;
+
+    /* consume the wakeup first, a push racing with us then leaves a (harmless) spurious one */
+    if(rbuf->efd >= 0){
+	uint64_t cnt;
+	(void) !read(rbuf->efd, &cnt, sizeof(cnt));
+    }
+
+    rbuf_lock(rbuf);
+    while(n < max && !rbuf_isempty(rbuf)){
+	out[n++] = rbuf->buf[rbuf->head];
+	rbuf->head = (rbuf->head + 1) % rbuf->capacity;
+	rbuf->size--;
+    }
+    /* left some behind, no empty to non-empty edge will come for them */
+    if(rbuf->efd >= 0 && !rbuf_isempty(rbuf))
+	rbuf_signal(rbuf);
+    rbuf_unlock(rbuf);
+
+    return n;
+}
+
 int rbuf_push(Rbuf *rbuf, int data){
+    rbuf_lock(rbuf);
     if(rbuf_isfull(rbuf)){
 	size_t new_capacity = rbuf->capacity << 1u;
 	size_t data_cnt_after_head = rbuf->capacity - rbuf->head;
 	void *tmp = realloc(rbuf->buf, sizeof(int) * new_capacity);
-	if(!tmp) return ERR_MALLOC_FAILED;
+	if(!tmp){
+	    rbuf_unlock(rbuf);
+	    return ERR_MALLOC_FAILED;
+	}
 	// invariant: tmp is malloc successfully
 	rbuf->buf = tmp;
 
@@ -113,13 +203,18 @@ int rbuf_push(Rbuf *rbuf, int data){
     // invariant: the rbuf has enough capacity to store data
     rbuf->buf[rbuf->tail] = data;
     rbuf->tail = (rbuf->tail + 1) % rbuf->capacity;    
-    rbuf->size++;
+    /* only the empty to non-empty edge costs a syscall */
+    if(rbuf->size++ == 0 && rbuf->efd >= 0)
+	rbuf_signal(rbuf);
+    rbuf_unlock(rbuf);
 
     return 0;
 }
 
 int rbuf_pop(Rbuf *rbuf){
+    rbuf_lock(rbuf);
     if(rbuf_isempty(rbuf)){
+      rbuf_unlock(rbuf);
       printf("The ring buffer is empty!\n");
       return EXIT_FAILURE;
     }
@@ -127,6 +222,7 @@ int rbuf_pop(Rbuf *rbuf){
     int pop_val = rbuf->buf[rbuf->head];
     rbuf->head = (rbuf->head + 1) % rbuf->capacity;
     rbuf->size--;
+    rbuf_unlock(rbuf);
     printf("Pop %d\n", pop_val);
     
     return 0;
@@ -154,3 +250,50 @@ int rbuf_isfull(Rbuf *rbuf){
 int rbuf_isempty(Rbuf *rbuf){
     return (rbuf->size == 0);
 }
+
+static void *rbuf_producer(void *arg){
+    ProducerArg *a = arg;
+    for(int i = 1; i <= a->n; ++i){
+	rbuf_push(a->rbuf, i);
+	/* pause now and then, so the consumer empties the queue and goes back to sleep */
+	if(i % RBUF_DRAIN_BATCH == 0)
+	    usleep(100);
+    }
+    return NULL;
+}
+
+/**
+ * push 1..n from a producer thread while this thread sleeps in poll on the
+ * eventfd and drains in batches. Turns notify mode on for good, the lock
+ * stays in use afterwards.
+ */
+int rbuf_stream(Rbuf *rbuf, int n){
+    ProducerArg arg = { .rbuf = rbuf, .n = n };
+    int out[RBUF_DRAIN_BATCH];
+    size_t want, got = 0, wakeups = 0;
+    long long sum = 0;
+    pthread_t tid;
+
+    int efd = rbuf_notify_enable(rbuf);
+    if(efd < 0) return -1;
+    want = rbuf->size + n;
+    if(pthread_create(&tid, NULL, rbuf_producer, &arg)) return -1;
+
+    struct pollfd pfd = { .fd = efd, .events = POLLIN };
+    while(got < want){
+	if(poll(&pfd, 1, -1) < 0){
+	    if(errno == EINTR) continue;
+	    perror("poll");
+	    break;
+	}
+	wakeups++;
+	size_t k = rbuf_drain(rbuf, out, RBUF_DRAIN_BATCH);
+	for(size_t i = 0; i < k; ++i)
+	    sum += out[i];
+	got += k;
+    }
+    pthread_join(tid, NULL);
+
+    printf("Drained %zu values in %zu wakeups, sum %lld\n", got, wakeups, sum);
+    return 0;
+}
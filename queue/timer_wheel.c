@@ -0,0 +1,189 @@
+#include    <stdlib.h>
+#include    "timer_wheel.h"
+
+static void list_init(Timer *head){
+    head->next = head;
+    head->prev = head;
+}
+
+static void list_add_tail(Timer *head, Timer *timer){
+    timer->prev = head->prev;
+    timer->next = head;
+    head->prev->next = timer;
+    head->prev = timer;
+}
+
+static void list_del(Timer *timer){
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = timer->prev = NULL;
+}
+
+/* move all timers of head onto tmp so callbacks can re-add into the same slot */
+static void list_splice(Timer *head, Timer *tmp){
+    list_init(tmp);
+    if(head->next == head)
+	return;
+    tmp->next = head->next;
+    tmp->prev = head->prev;
+    tmp->next->prev = tmp;
+    tmp->prev->next = tmp;
+    list_init(head);
+}
+
+static void slot_mark(TimerWheel *tw, unsigned int level, size_t slot){
+    tw->pending[level][slot >> 6] |= (uint64_t) 1 << (slot & 63);
+}
+
+static void slot_unmark(TimerWheel *tw, unsigned int level, size_t slot){
+    tw->pending[level][slot >> 6] &= ~((uint64_t) 1 << (slot & 63));
+}
+
+/* first non-empty slot of level at or after from, TW_SLOTS if none */
+static size_t slot_find(const TimerWheel *tw, unsigned int level, size_t from){
+    for(size_t w = from >> 6; w < TW_SLOTS / 64; ++w){
+	uint64_t bits = tw->pending[level][w];
+	if(w == from >> 6)
+	    bits &= ~(uint64_t) 0 << (from & 63);
+	if(bits)
+	    return (w << 6) + __builtin_ctzll(bits);
+    }
+    return TW_SLOTS;
+}
+
+/* lowest level whose ring still separates expires from now */
+static void timer_place(TimerWheel *tw, Timer *timer){
+    uint64_t expires = timer->expires;
+    uint64_t now = tw->now;
+    unsigned int level = 0;
+    size_t slot;
+
+    while(level < TW_LEVELS && (expires >> ((level + 1) * TW_SLOT_BITS)) != (now >> ((level + 1) * TW_SLOT_BITS)))
+	level++;
+
+    if(level == TW_LEVELS){ /* beyond the top ring, park in slot 0: it is cascaded when the top ring wraps, never after expires */
+	level = TW_LEVELS - 1;
+	slot = 0;
+    } else
+	slot = (expires >> (level * TW_SLOT_BITS)) & TW_SLOT_MASK;
+
+    timer->level = level;
+    timer->slot = slot;
+    slot_mark(tw, level, slot);
+    list_add_tail(&tw->slots[level][slot], timer);
+}
+
+static void timer_unlink(TimerWheel *tw, Timer *timer){
+    Timer *head = &tw->slots[timer->level][timer->slot];
+    list_del(timer);
+    if(head->next == head)
+	slot_unmark(tw, timer->level, timer->slot);
+}
+
+static void timer_cascade(TimerWheel *tw, unsigned int level){
+    Timer tmp;
+    size_t slot = (tw->now >> (level * TW_SLOT_BITS)) & TW_SLOT_MASK;
+
+    list_splice(&tw->slots[level][slot], &tmp);
+    slot_unmark(tw, level, slot);
+    while(tmp.next != &tmp){
+	Timer *timer = tmp.next;
+	list_del(timer);
+	timer_place(tw, timer);
+    }
+}
+
+/**
+ * level l cascades slot s at the ticks that are multiples of TW_SLOTS^l and
+ * have s as their level l digit (level 0 fires every tick), so the earliest
+ * marked slot past now on every ring gives the next tick with work to do.
+ * A ring with nothing ahead in this rotation looks at the next one, where
+ * only the top ring can hold anything: the timers parked in its slot 0.
+ */
+static uint64_t timer_next_tick(const TimerWheel *tw){
+    uint64_t next = UINT64_MAX;
+
+    for(unsigned int level = 0; level < TW_LEVELS; ++level){
+	unsigned int shift = level * TW_SLOT_BITS;
+	uint64_t base = tw->now >> (shift + TW_SLOT_BITS) << (shift + TW_SLOT_BITS);
+	size_t slot = slot_find(tw, level, ((tw->now >> shift) & TW_SLOT_MASK) + 1);
+
+	if(slot == TW_SLOTS){
+	    slot = slot_find(tw, level, 0);
+	    if(slot == TW_SLOTS)
+		continue;
+	    base += (uint64_t) 1 << (shift + TW_SLOT_BITS);
+	}
+	uint64_t tick = base + ((uint64_t) slot << shift);
+	if(tick < next)
+	    next = tick;
+    }
+    return next;
+}
+
+int timer_wheel_init(TimerWheel *tw, uint64_t now){
+    tw->now = now;
+    tw->size = 0;
+    for(size_t l = 0; l < TW_LEVELS; ++l){
+	for(size_t w = 0; w < TW_SLOTS / 64; ++w)
+	    tw->pending[l][w] = 0;
+	for(size_t s = 0; s < TW_SLOTS; ++s)
+	    list_init(&tw->slots[l][s]);
+    }
+    return 0;
+}
+
+int timer_add(TimerWheel *tw, Timer *timer, uint64_t expires, timer_fn fn, void *arg){
+    if(timer_pending(timer))
+	return -1;
+    /* already due: fire on the next tick */
+    timer->expires = expires > tw->now ? expires : tw->now + 1;
+    timer->fn = fn;
+    timer->arg = arg;
+    timer_place(tw, timer);
+    tw->size++;
+    return 0;
+}
+
+int timer_cancel(TimerWheel *tw, Timer *timer){
+    if(!timer_pending(timer))
+	return -1;
+    timer_unlink(tw, timer);
+    tw->size--;
+    return 0;
+}
+
+size_t timer_wheel_advance(TimerWheel *tw, uint64_t now){
+    size_t fired = 0;
+
+    while(tw->now < now){
+	/* ticks in between have nothing to fire or cascade, jump over them */
+	uint64_t next = tw->size ? timer_next_tick(tw) : UINT64_MAX;
+	if(next > now){
+	    tw->now = now;
+	    break;
+	}
+	tw->now = next;
+
+	/* a lower ring wrapped: pull the next slot of the ring above down, top first */
+	unsigned int top = 0;
+	while(top + 1 < TW_LEVELS && ((tw->now >> ((top + 1) * TW_SLOT_BITS)) << ((top + 1) * TW_SLOT_BITS)) == tw->now)
+	    top++;
+	for(unsigned int level = top; level > 0; --level)
+	    timer_cascade(tw, level);
+
+	Timer tmp;
+	size_t slot = tw->now & TW_SLOT_MASK;
+	list_splice(&tw->slots[0][slot], &tmp);
+	slot_unmark(tw, 0, slot);
+	while(tmp.next != &tmp){
+	    Timer *timer = tmp.next;
+	    list_del(timer);
+	    tw->size--;
+	    fired++;
+	    timer->fn(timer, timer->arg);
+	}
+    }
+
+    return fired;
+}
@@ -0,0 +1,56 @@
+#ifndef	    TIMER_WHEEL_H
+#define	    TIMER_WHEEL_H
+
+#include    <stddef.h>
+#include    <stdint.h>
+
+#define	    TW_LEVELS		4u
+#define	    TW_SLOT_BITS	8u
+#define	    TW_SLOTS		(1u << TW_SLOT_BITS)
+#define	    TW_SLOT_MASK	(TW_SLOTS - 1)
+
+/**
+ * Hierarchical timing wheel (Varghese & Lauck). Each level is a ring of slots
+ * indexed the same way as the ring buffer, tick & mask; level l covers
+ * TW_SLOTS^(l + 1) ticks. A slot is a circular doubly linked list of timers,
+ * so add and cancel are O(1); advance fires level 0 slots and, whenever a lower
+ * ring wraps, cascades the next slot of the ring above down into it. A bitmap
+ * per ring marks the non-empty slots, so advance jumps straight to the next
+ * tick that fires or cascades something instead of stepping through empty ones.
+ *
+ * A Timer must be zeroed (or left over from a fire or cancel) before its first
+ * timer_add: a non-NULL next reads as already pending and the add is refused.
+ */
+typedef struct timer Timer;
+typedef void (*timer_fn)(Timer *timer, void *arg);
+
+struct timer {
+    Timer *next;         /* NULL when not pending */
+    Timer *prev;
+    uint64_t expires;    /* absolute tick */
+    timer_fn fn;
+    void *arg;
+    unsigned int level;  /* ring and slot the timer sits in */
+    unsigned int slot;
+};
+
+typedef struct timer_wheel {
+    uint64_t now;
+    size_t size;
+    uint64_t pending[TW_LEVELS][TW_SLOTS / 64];     /* bit set: slot not empty */
+    Timer slots[TW_LEVELS][TW_SLOTS];   /* list heads */
+} TimerWheel;
+
+int timer_wheel_init(TimerWheel *tw, uint64_t now);
+
+int timer_add(TimerWheel *tw, Timer *timer, uint64_t expires, timer_fn fn, void *arg);
+
+int timer_cancel(TimerWheel *tw, Timer *timer);
+
+size_t timer_wheel_advance(TimerWheel *tw, uint64_t now);   /* fire everything up to now, return how many */
+
+static inline int timer_pending(Timer *timer){
+    return timer->next != NULL;
+}
+
+#endif
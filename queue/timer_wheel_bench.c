@@ -0,0 +1,114 @@
+/* timer wheel vs the deap used as a timer min-heap: schedule, expire, cancel */
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    <time.h>
+#include    "timer_wheel.h"
+#include    "../advanced_trees/deap.h"
+
+#define	    NTIMERS	1000000u	/* dense: about one timer per tick */
+#define	    NSPARSE	10000u		/* sparse: most ticks have nothing to do */
+#define	    MAX_DELAY	(1u << 20)	/* ticks */
+#define	    TICK_STEP	64u		/* event loop granularity */
+
+static size_t wheel_fired;
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void on_expire(Timer *timer, void *arg){
+    (void) timer;
+    (void) arg;
+    wheel_fired++;
+}
+
+/* add every timer, then run the loop until all of them fired */
+static double bench_wheel(Timer *timers, const unsigned int *delays, size_t n){
+    TimerWheel *tw = malloc(sizeof(TimerWheel));
+    if(!tw) return 0;
+    double start = now_sec();
+
+    timer_wheel_init(tw, 0);
+    for(size_t i = 0; i < n; ++i)
+	timer_add(tw, &timers[i], delays[i], on_expire, NULL);
+    for(uint64_t now = 0; tw->size; now += TICK_STEP)
+	timer_wheel_advance(tw, now);
+
+    double elapsed = now_sec() - start;
+    free(tw);
+    return elapsed;
+}
+
+static double bench_deap(const unsigned int *delays, size_t n, size_t *fired){
+    Deap deap;
+    double start = now_sec();
+
+    deap_init(&deap);
+    for(size_t i = 0; i < n; ++i)
+	deap_insert(&deap, delays[i]);
+    for(unsigned int now = 0; deap.size; now += TICK_STEP)
+	while(deap.size && deap.arr[1] <= (int) now){   /* arr[1] is the min heap root */
+	    deap_delete_min(&deap);
+	    (*fired)++;
+	}
+
+    double elapsed = now_sec() - start;
+    deap_destroy(&deap);
+    return elapsed;
+}
+
+/* most timeouts never fire: arm then disarm, the heap has no handle to do this */
+static double bench_wheel_cancel(Timer *timers, const unsigned int *delays, size_t n){
+    TimerWheel *tw = malloc(sizeof(TimerWheel));
+    if(!tw) return 0;
+    double start = now_sec();
+
+    timer_wheel_init(tw, 0);
+    for(size_t i = 0; i < n; ++i)
+	timer_add(tw, &timers[i], delays[i], on_expire, NULL);
+    for(size_t i = 0; i < n; ++i)
+	timer_cancel(tw, &timers[i]);
+
+    double elapsed = now_sec() - start;
+    free(tw);
+    return elapsed;
+}
+
+int main(){
+    static const size_t counts[] = { NTIMERS, NSPARSE };
+    unsigned int *delays = malloc(sizeof(unsigned int) * NTIMERS);
+    Timer *timers = malloc(sizeof(Timer) * NTIMERS);
+    if(!delays || !timers){
+	perror("malloc failed");
+	return 1;
+    }
+
+    srand(1);
+    for(size_t i = 0; i < NTIMERS; ++i)
+	delays[i] = 1 + rand() % MAX_DELAY;
+
+    printf("delays up to %u ticks, advance every %u ticks\n", MAX_DELAY, TICK_STEP);
+    for(size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); ++k){
+	size_t n = counts[k], deap_fired = 0;
+
+	/* timers must be zeroed before their first timer_add */
+	memset(timers, 0, sizeof(Timer) * n);
+	wheel_fired = 0;
+	double w = bench_wheel(timers, delays, n);
+	double d = bench_deap(delays, n, &deap_fired);
+	double c = bench_wheel_cancel(timers, delays, n);
+
+	printf("%zu timers\n", n);
+	printf("  %-20s %12.1f ns/timer (%zu fired)\n", "wheel add+expire", w / n * 1e9, wheel_fired);
+	printf("  %-20s %12.1f ns/timer (%zu fired)\n", "deap add+expire", d / n * 1e9, deap_fired);
+	printf("  %-20s %12.1f ns/timer\n", "wheel add+cancel", c / n * 1e9);
+    }
+
+    free(timers);
+    free(delays);
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include    <stdlib.h>
+#include    "seg_stack.h"
+
+static void seg_stack_enter(SegStack *s, SegChunk *chunk, size_t used){
+    s->chunk = chunk;
+    s->top = chunk->elems + used;
+    s->limit = chunk->elems + SEG_STACK_CHUNK_CAP;
+}
+
+int seg_stack_init(SegStack *s){
+    SegChunk *chunk = malloc(sizeof(SegChunk));
+    if(!chunk) return ERR_MALLOC_FAILED;
+    chunk->prev = NULL;
+    seg_stack_enter(s, chunk, 0);
+    s->cache = NULL;
+    s->cache_cnt = 0;
+    s->size = 0;
+    return 0;
+}
+
+int seg_stack_destruct(SegStack *s){
+    SegChunk *chunk = s->chunk;
+    while(chunk){
+	SegChunk *prev = chunk->prev;
+	free(chunk);
+	chunk = prev;
+    }
+
+    chunk = s->cache;
+    while(chunk){
+	SegChunk *prev = chunk->prev;
+	free(chunk);
+	chunk = prev;
+    }
+
+    s->chunk = s->cache = NULL;
+    s->top = s->limit = NULL;
+    s->size = s->cache_cnt = 0;
+    return 0;
+}
+
+/* current chunk is full: move up to a cached chunk or a new one */
+int seg_stack_grow(SegStack *s){
+    SegChunk *chunk = s->cache;
+
+    if(chunk){
+	s->cache = chunk->prev;
+	s->cache_cnt--;
+    } else {
+	chunk = malloc(sizeof(SegChunk));
+	if(!chunk) return ERR_MALLOC_FAILED;
+    }
+    // invariant: chunk is usable
+    chunk->prev = s->chunk;
+    seg_stack_enter(s, chunk, 0);
+    return 0;
+}
+
+/* current chunk is empty and not the bottom one: park it and move down */
+void seg_stack_shrink(SegStack *s){
+    SegChunk *chunk = s->chunk;
+    SegChunk *prev = chunk->prev;
+
+    if(s->cache_cnt < SEG_STACK_CACHE_MAX){
+	chunk->prev = s->cache;
+	s->cache = chunk;
+	s->cache_cnt++;
+    } else
+	free(chunk);
+
+    seg_stack_enter(s, prev, SEG_STACK_CHUNK_CAP);
+}
@@ -0,0 +1,69 @@
+#ifndef	    SEG_STACK_H
+#define	    SEG_STACK_H
+
+#include    <stddef.h>
+
+#define	    ERR_MALLOC_FAILED	-1
+#define	    ERR_STACK_EMPTY	-2
+
+#define	    SEG_STACK_CHUNK_CAP	256u	/* elements per chunk */
+#define	    SEG_STACK_CACHE_MAX	2u	/* empty chunks kept instead of freed */
+
+/**
+ * Segmented stack: fixed-size chunks linked downwards, so growing never moves
+ * an element. Popping out of a chunk parks it in a small cache, pushing into a
+ * new chunk takes from the cache first, so bouncing on a chunk boundary does not
+ * hit malloc. Only the chunk boundary goes out of line.
+ */
+typedef struct seg_chunk {
+    struct seg_chunk *prev;
+    void *elems[SEG_STACK_CHUNK_CAP];
+} SegChunk;
+
+typedef struct seg_stack {
+    void **top;          /* next free slot in chunk */
+    void **limit;        /* one past the last slot of chunk */
+    SegChunk *chunk;     /* chunk holding the top */
+    SegChunk *cache;     /* empty chunks, linked by prev */
+    size_t cache_cnt;
+    size_t size;
+} SegStack;
+
+int seg_stack_init(SegStack *s);
+
+int seg_stack_destruct(SegStack *s);
+
+int seg_stack_grow(SegStack *s);
+
+void seg_stack_shrink(SegStack *s);
+
+static inline int seg_stack_isempty(SegStack *s){
+    return (s->size == 0);
+}
+
+static inline int seg_stack_push(SegStack *s, void *val){
+    if(s->top == s->limit && seg_stack_grow(s) < 0)
+	return ERR_MALLOC_FAILED;
+    *s->top++ = val;
+    s->size++;
+    return 0;
+}
+
+static inline int seg_stack_pop(SegStack *s, void **val){
+    if(s->size == 0)
+	return ERR_STACK_EMPTY;
+    if(s->top == s->chunk->elems)
+	seg_stack_shrink(s);
+    // invariant: the current chunk has entities
+    *val = *--s->top;
+    s->size--;
+    return 0;
+}
+
+static inline void *seg_stack_peek(SegStack *s){
+    if(s->size == 0)
+	return NULL;
+    return s->top == s->chunk->elems ? s->chunk->prev->elems[SEG_STACK_CHUNK_CAP - 1] : s->top[-1];
+}
+
+#endif
@@ -0,0 +1,133 @@
+/* contention benchmark: Treiber stack with elimination vs a mutex stack, 1 to 64 threads */
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <pthread.h>
+#include    <time.h>
+#include    "treiber_stack.h"
+
+#define	    OPS_PER_THREAD	200000u
+#define	    MAX_THREADS		64u
+
+typedef struct mutex_stack {
+    pthread_mutex_t lock;
+    void **buf;
+    size_t size;
+    size_t capacity;
+} MutexStack;
+
+typedef struct bench_arg {
+    TStack *tstack;
+    MutexStack *mstack;
+    pthread_barrier_t *barrier;
+    size_t ops;
+} BenchArg;
+
+static int mstack_init(MutexStack *s, size_t capacity){
+    s->buf = malloc(sizeof(void *) * capacity);
+    if(!s->buf) return -1;
+    pthread_mutex_init(&s->lock, NULL);
+    s->size = 0;
+    s->capacity = capacity;
+    return 0;
+}
+
+static int mstack_destruct(MutexStack *s){
+    pthread_mutex_destroy(&s->lock);
+    free(s->buf);
+    return 0;
+}
+
+static int mstack_push(MutexStack *s, void *val){
+    int ret = 0;
+    pthread_mutex_lock(&s->lock);
+    if(s->size == s->capacity)
+	ret = ERR_STACK_FULL;
+    else
+	s->buf[s->size++] = val;
+    pthread_mutex_unlock(&s->lock);
+    return ret;
+}
+
+static int mstack_pop(MutexStack *s, void **val){
+    int ret = 0;
+    pthread_mutex_lock(&s->lock);
+    if(s->size == 0)
+	ret = ERR_STACK_EMPTY;
+    else
+	*val = s->buf[--s->size];
+    pthread_mutex_unlock(&s->lock);
+    return ret;
+}
+
+/* each thread does push/pop pairs, so pushes and pops arrive together and can eliminate */
+static void *tstack_worker(void *arg){
+    BenchArg *a = arg;
+    void *val;
+    pthread_barrier_wait(a->barrier);
+    for(size_t i = 0; i < a->ops; ++i){
+	tstack_push(a->tstack, (void *) (i + 1));
+	tstack_pop(a->tstack, &val);
+    }
+    return NULL;
+}
+
+static void *mstack_worker(void *arg){
+    BenchArg *a = arg;
+    void *val;
+    pthread_barrier_wait(a->barrier);
+    for(size_t i = 0; i < a->ops; ++i){
+	mstack_push(a->mstack, (void *) (i + 1));
+	mstack_pop(a->mstack, &val);
+    }
+    return NULL;
+}
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double run(void *(*worker)(void *), BenchArg *tmpl, size_t nthreads){
+    pthread_t tids[MAX_THREADS];
+    pthread_barrier_t barrier;
+    BenchArg arg = *tmpl;
+    double start;
+
+    pthread_barrier_init(&barrier, NULL, nthreads + 1);
+    arg.barrier = &barrier;
+    arg.ops = OPS_PER_THREAD;
+    for(size_t i = 0; i < nthreads; ++i)
+	pthread_create(&tids[i], NULL, worker, &arg);
+
+    start = now_sec();
+    pthread_barrier_wait(&barrier);
+    for(size_t i = 0; i < nthreads; ++i)
+	pthread_join(tids[i], NULL);
+
+    pthread_barrier_destroy(&barrier);
+    return (2.0 * OPS_PER_THREAD * nthreads) / (now_sec() - start);
+}
+
+int main(){
+    TStack tstack;
+    MutexStack mstack;
+    BenchArg arg = { .tstack = &tstack, .mstack = &mstack };
+
+    if(tstack_init(&tstack, MAX_THREADS * 2) < 0 || mstack_init(&mstack, MAX_THREADS * 2) < 0){
+	fprintf(stderr, "init failed\n");
+	return EXIT_FAILURE;
+    }
+
+    printf("%8s %16s %16s\n", "threads", "treiber ops/s", "mutex ops/s");
+    for(size_t n = 1; n <= MAX_THREADS; n <<= 1u){
+	double t = run(tstack_worker, &arg, n);
+	double m = run(mstack_worker, &arg, n);
+	printf("%8zu %16.0f %16.0f\n", n, t, m);
+    }
+
+    tstack_destruct(&tstack);
+    mstack_destruct(&mstack);
+    return 0;
+}
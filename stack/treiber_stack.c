@@ -0,0 +1,154 @@
+#include    <stdlib.h>
+#include    "treiber_stack.h"
+
+#define	    NIL			0u
+#define	    ELIM_EMPTY		0u
+#define	    ELIM_TAKEN		UINT64_MAX
+
+#define	    ref_idx(ref)	((uint32_t) (ref))              /* index + 1 */
+#define	    ref_tag(ref)	((uint32_t) ((ref) >> 32))
+#define	    ref_make(tag, idx)	(((uint64_t) (tag) << 32) | (idx))
+
+static _Thread_local uint32_t seed;
+
+static uint32_t rand_slot(void){
+    if(!seed)
+	seed = (uint32_t) (uintptr_t) &seed | 1u;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed & (TSTACK_ELIM_SIZE - 1);
+}
+
+/* push node idx (index + 1) onto a tagged list head, one attempt */
+static int list_try_push(TStack *s, _Atomic uint64_t *head, uint32_t idx){
+    uint64_t old = atomic_load_explicit(head, memory_order_acquire);
+    atomic_store_explicit(&s->nodes[idx - 1].next, ref_idx(old), memory_order_relaxed);
+    return atomic_compare_exchange_weak_explicit(head, &old, ref_make(ref_tag(old) + 1, idx),
+	    memory_order_release, memory_order_relaxed);
+}
+
+/* pop from a tagged list head, one attempt: index + 1, NIL when empty, -1 on contention */
+static int64_t list_try_pop(TStack *s, _Atomic uint64_t *head){
+    uint64_t old = atomic_load_explicit(head, memory_order_acquire);
+    uint32_t idx = ref_idx(old);
+    if(idx == NIL)
+	return NIL;
+
+    uint32_t next = atomic_load_explicit(&s->nodes[idx - 1].next, memory_order_relaxed);
+    if(!atomic_compare_exchange_weak_explicit(head, &old, ref_make(ref_tag(old) + 1, next),
+		memory_order_acquire, memory_order_relaxed))
+	return -1;
+    return idx;
+}
+
+static uint32_t node_alloc(TStack *s){
+    int64_t idx;
+    while((idx = list_try_pop(s, &s->free)) < 0)
+	;
+    return (uint32_t) idx;
+}
+
+static void node_free(TStack *s, uint32_t idx){
+    while(!list_try_push(s, &s->free, idx))
+	;
+}
+
+/* offer idx in a random slot, 1 if a popper took it */
+static int elim_push(TStack *s, uint32_t idx){
+    _Atomic uint64_t *slot = &s->elim[rand_slot()].offer;
+    uint64_t expected = ELIM_EMPTY;
+
+    if(!atomic_compare_exchange_strong_explicit(slot, &expected, idx,
+		memory_order_release, memory_order_relaxed))
+	return 0;
+
+    for(unsigned int i = 0; i < TSTACK_ELIM_SPINS; ++i){
+	if(atomic_load_explicit(slot, memory_order_acquire) == ELIM_TAKEN){
+	    atomic_store_explicit(slot, ELIM_EMPTY, memory_order_release);
+	    return 1;
+	}
+    }
+
+    /* withdraw, if that fails a popper got there first */
+    expected = idx;
+    if(atomic_compare_exchange_strong_explicit(slot, &expected, ELIM_EMPTY,
+		memory_order_relaxed, memory_order_relaxed))
+	return 0;
+    atomic_store_explicit(slot, ELIM_EMPTY, memory_order_release);
+    return 1;
+}
+
+/* take a pusher's offer from a random slot, index + 1 or NIL */
+static uint32_t elim_pop(TStack *s){
+    _Atomic uint64_t *slot = &s->elim[rand_slot()].offer;
+    uint64_t offer = atomic_load_explicit(slot, memory_order_acquire);
+
+    if(offer == ELIM_EMPTY || offer == ELIM_TAKEN)
+	return NIL;
+    if(!atomic_compare_exchange_strong_explicit(slot, &offer, ELIM_TAKEN,
+		memory_order_acquire, memory_order_relaxed))
+	return NIL;
+    return (uint32_t) offer;
+}
+
+int tstack_init(TStack *s, size_t capacity){
+    if(capacity == 0 || capacity >= UINT32_MAX) return -1;
+    s->nodes = malloc(sizeof(TStackNode) * capacity);
+    if(!s->nodes) return -1;
+    s->capacity = capacity;
+
+    /* every node starts on the free list */
+    for(size_t i = 0; i < capacity; ++i){
+	s->nodes[i].val = NULL;
+	atomic_init(&s->nodes[i].next, i + 1 < capacity ? (uint32_t) (i + 2) : NIL);
+    }
+    atomic_init(&s->top, ref_make(0, NIL));
+    atomic_init(&s->free, ref_make(0, 1));
+    for(size_t i = 0; i < TSTACK_ELIM_SIZE; ++i)
+	atomic_init(&s->elim[i].offer, ELIM_EMPTY);
+
+    return 0;
+}
+
+int tstack_destruct(TStack *s){
+    free(s->nodes);
+    s->nodes = NULL;
+    return 0;
+}
+
+int tstack_push(TStack *s, void *val){
+    uint32_t idx = node_alloc(s);
+    if(idx == NIL)
+	return ERR_STACK_FULL;
+    s->nodes[idx - 1].val = val;
+
+    for(;;){
+	if(list_try_push(s, &s->top, idx))
+	    return 0;
+	// invariant: CAS on top failed, someone else is on it, try to meet a popper
+	if(elim_push(s, idx))
+	    return 0;
+    }
+}
+
+int tstack_pop(TStack *s, void **val){
+    int64_t idx;
+    uint32_t offer;
+
+    for(;;){
+	if((idx = list_try_pop(s, &s->top)) == NIL)
+	    return ERR_STACK_EMPTY;
+	if(idx > 0)
+	    break;
+	// invariant: CAS on top failed, try to meet a pusher
+	if((offer = elim_pop(s)) != NIL){
+	    idx = offer;
+	    break;
+	}
+    }
+
+    *val = s->nodes[idx - 1].val;
+    node_free(s, (uint32_t) idx);
+    return 0;
+}
@@ -0,0 +1,47 @@
+#ifndef	    TREIBER_STACK_H
+#define	    TREIBER_STACK_H
+
+#include    <stddef.h>
+#include    <stdint.h>
+#include    <stdalign.h>
+#include    <stdatomic.h>
+
+#define	    ERR_STACK_FULL	-1
+#define	    ERR_STACK_EMPTY	-2
+
+#define	    TSTACK_ELIM_SIZE	16u	/* elimination slots, power of 2 */
+#define	    TSTACK_ELIM_SPINS	128u	/* how long a pusher waits in a slot for a popper */
+
+/**
+ * Lock-free Treiber stack with elimination backoff (Hendler, Shavit, Yerushalmi).
+ * Nodes come from a fixed pool and are named by index, the top (and the free list)
+ * is a 64-bit word of (tag << 32 | index + 1). The tag is bumped on every CAS, so
+ * a node popped and pushed back between a load and a CAS cannot fool it (ABA),
+ * and nodes are never freed while the stack lives, so a stale next is safe to read.
+ */
+typedef struct tstack_node {
+    void *val;
+    _Atomic uint32_t next;        /* index + 1, 0 is nil */
+} TStackNode;
+
+typedef struct tstack_slot {
+    alignas(64) _Atomic uint64_t offer;   /* 0 empty, index + 1 offered by a pusher, TAKEN by a popper */
+} TStackSlot;
+
+typedef struct tstack {
+    alignas(64) _Atomic uint64_t top;
+    alignas(64) _Atomic uint64_t free;
+    TStackNode *nodes;
+    size_t capacity;
+    TStackSlot elim[TSTACK_ELIM_SIZE];
+} TStack;
+
+int tstack_init(TStack *s, size_t capacity);
+
+int tstack_destruct(TStack *s);
+
+int tstack_push(TStack *s, void *val);
+
+int tstack_pop(TStack *s, void **val);
+
+#endif